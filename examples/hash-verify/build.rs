@@ -0,0 +1,23 @@
+fn main() {
+    println!("cargo:rerun-if-changed=csrc/core_hash.c");
+    println!("cargo:rerun-if-changed=csrc/plugin_hash.c");
+    println!("cargo:rerun-if-changed=../../pgdog/src/frontend/router/sharding/hashfn.c");
+    println!("cargo:rerun-if-changed=../../pgdog/src/frontend/router/sharding/postgres_hash.h");
+    println!("cargo:rerun-if-changed=../../plugins/pgdog-routing/postgres_hash/hashfn.c");
+    println!("cargo:rerun-if-changed=../../plugins/pgdog-routing/postgres_hash/postgres_hash.h");
+
+    // Each copy of hashfn.c is compiled into its own library with
+    // prefixed symbols, so the harness can link both and compare
+    // their output byte for byte.
+    cc::Build::new()
+        .file("csrc/core_hash.c")
+        .include("../../pgdog/src/frontend/router/sharding")
+        .opt_level(3)
+        .compile("core_hash");
+
+    cc::Build::new()
+        .file("csrc/plugin_hash.c")
+        .include("../../plugins/pgdog-routing/postgres_hash")
+        .opt_level(3)
+        .compile("plugin_hash");
+}
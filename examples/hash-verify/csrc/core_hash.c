@@ -0,0 +1,24 @@
+/*
+ * pgDog's copy of hashfn.c, compiled with core_-prefixed symbols so
+ * the harness can link it next to the plugin's copy.
+ */
+#define hash_combine64 core_hash_combine64
+#define hash_bytes_extended core_hash_bytes_extended
+#define hashint8extended core_hashint8extended
+#define hashint4extended core_hashint4extended
+#define hashint2extended core_hashint2extended
+#define hash_bytes_extended_batch core_hash_bytes_extended_batch
+#define hashint8extended_batch core_hashint8extended_batch
+#define shard_for_key core_shard_for_key
+
+#include "../../../pgdog/src/frontend/router/sharding/hashfn.c"
+
+/*
+ * The uint32 helper lives in the shared postgres_hash.h header and
+ * isn't reached through the exported entry points; wrap it so the
+ * harness compares it across copies too.
+ */
+uint64 core_hash_bytes_uint32_extended(uint32 k)
+{
+	return pg_hash_uint32_extended(k);
+}
@@ -0,0 +1,25 @@
+/*
+ * The routing plugin's copy of hashfn.c, compiled with
+ * plugin_-prefixed symbols so the harness can link it next to
+ * pgDog's copy.
+ */
+#define hash_combine64 plugin_hash_combine64
+#define hash_bytes_extended plugin_hash_bytes_extended
+#define hashint8extended plugin_hashint8extended
+#define hashint4extended plugin_hashint4extended
+#define hashint2extended plugin_hashint2extended
+#define hash_bytes_extended_batch plugin_hash_bytes_extended_batch
+#define hashint8extended_batch plugin_hashint8extended_batch
+#define shard_for_key plugin_shard_for_key
+
+#include "../../../plugins/pgdog-routing/postgres_hash/hashfn.c"
+
+/*
+ * The uint32 helper lives in the shared postgres_hash.h header and
+ * isn't reached through the exported entry points; wrap it so the
+ * harness compares it across copies too.
+ */
+uint64 plugin_hash_bytes_uint32_extended(uint32 k)
+{
+	return pg_hash_uint32_extended(k);
+}
@@ -0,0 +1,296 @@
+//! Verify the postgres_hash library before an upgrade.
+//!
+//! hashfn.c exists in two copies — pgDog's router and the routing
+//! plugin — and any drift between them, or from upstream
+//! PostgreSQL, silently routes rows to the wrong shard. That's data
+//! corruption, not slowness. This harness links both copies with
+//! prefixed symbols and:
+//!
+//! - asserts bit-exact equality between the copies for key sizes
+//!   0–1KB, the integer specializations, the batch variants (which
+//!   take the AVX2 path where available) and the jump consistent
+//!   hash;
+//! - checks golden vectors generated from a real PostgreSQL
+//!   instance, when given;
+//! - reports GB/s throughput per key-size bucket, so SIMD changes
+//!   can be validated for speed as well as correctness.
+//!
+//! ```bash
+//! cargo run --release -p hash-verify
+//! cargo run --release -p hash-verify -- --golden golden.jsonl
+//! ```
+//!
+//! Golden vectors are one JSON object per line, `{"key": "<hex>",
+//! "hash": <bigint>}`, generated from PostgreSQL with the hash
+//! partition seed, e.g.:
+//!
+//! ```sql
+//! SELECT json_build_object(
+//!     'key', encode(k, 'hex'),
+//!     'hash', hashbyteaextended(k, 8816678312871386365)
+//! ) FROM keys;
+//! ```
+//!
+//! (8816678312871386365 is HASH_PARTITION_SEED; the C library bakes
+//! it in. Use hashint8extended(v, seed) for integer vectors with
+//! `{"int8": v, "hash": ...}` lines.)
+
+use clap::Parser;
+use std::fs::read_to_string;
+use std::time::Instant;
+
+extern "C" {
+    fn core_hash_combine64(a: u64, b: u64) -> u64;
+    fn core_hash_bytes_extended(k: *const u8, keylen: i32) -> u64;
+    fn core_hashint8extended(k: i64) -> u64;
+    fn core_hashint4extended(k: i32) -> u64;
+    fn core_hashint2extended(k: i16) -> u64;
+    fn core_hash_bytes_uint32_extended(k: u32) -> u64;
+    fn core_hash_bytes_extended_batch(keys: *const *const u8, lens: *const i32, out: *mut u64, n: i32);
+    fn core_hashint8extended_batch(vals: *const i64, out: *mut u64, n: i32);
+    fn core_shard_for_key(key: u64, num_shards: i32) -> i32;
+
+    fn plugin_hash_combine64(a: u64, b: u64) -> u64;
+    fn plugin_hash_bytes_extended(k: *const u8, keylen: i32) -> u64;
+    fn plugin_hashint8extended(k: i64) -> u64;
+    fn plugin_hashint4extended(k: i32) -> u64;
+    fn plugin_hashint2extended(k: i16) -> u64;
+    fn plugin_hash_bytes_uint32_extended(k: u32) -> u64;
+    fn plugin_hash_bytes_extended_batch(keys: *const *const u8, lens: *const i32, out: *mut u64, n: i32);
+    fn plugin_hashint8extended_batch(vals: *const i64, out: *mut u64, n: i32);
+    fn plugin_shard_for_key(key: u64, num_shards: i32) -> i32;
+}
+
+#[derive(Parser)]
+struct Args {
+    /// Golden vectors generated from a real PostgreSQL instance,
+    /// one JSON object per line.
+    #[arg(long)]
+    golden: Option<String>,
+    /// Keys hashed per size bucket in the throughput report.
+    #[arg(long, default_value = "1000000")]
+    throughput_keys: usize,
+}
+
+/// splitmix64: deterministic key material, different every byte.
+fn splitmix64(state: &mut u64) -> u64 {
+    *state = state.wrapping_add(0x9E3779B97F4A7C15);
+    let mut z = *state;
+    z = (z ^ (z >> 30)).wrapping_mul(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)).wrapping_mul(0x94D049BB133111EB);
+    z ^ (z >> 31)
+}
+
+fn key_material(len: usize, seed: u64) -> Vec<u8> {
+    let mut state = seed;
+    let mut key = Vec::with_capacity(len);
+    while key.len() < len {
+        key.extend_from_slice(&splitmix64(&mut state).to_le_bytes());
+    }
+    key.truncate(len);
+    key
+}
+
+/// Both copies must agree on every input. Returns the number of
+/// comparisons made.
+fn verify_copies() -> usize {
+    let mut checked = 0;
+
+    // Variable-length keys, every size from empty to 1KB, several
+    // keys per size so alignment tails are covered.
+    for len in 0..=1024usize {
+        for seed in 0..4u64 {
+            let key = key_material(len, 0x5EED + seed + len as u64);
+            let (core, plugin) = unsafe {
+                (
+                    core_hash_bytes_extended(key.as_ptr(), key.len() as i32),
+                    plugin_hash_bytes_extended(key.as_ptr(), key.len() as i32),
+                )
+            };
+            assert_eq!(core, plugin, "hash_bytes_extended drift at len {}", len);
+            checked += 1;
+        }
+    }
+
+    // Integer specializations and their widening invariant: int2
+    // and int4 keys must hash like the widened int8.
+    let mut state = 0xC0FFEE;
+    for _ in 0..100_000 {
+        let val = splitmix64(&mut state) as i64;
+        unsafe {
+            assert_eq!(core_hashint8extended(val), plugin_hashint8extended(val));
+            let val4 = val as i32;
+            assert_eq!(core_hashint4extended(val4), plugin_hashint4extended(val4));
+            assert_eq!(core_hashint4extended(val4), core_hashint8extended(val4 as i64));
+            let val2 = val as i16;
+            assert_eq!(core_hashint2extended(val2), plugin_hashint2extended(val2));
+            assert_eq!(core_hashint2extended(val2), core_hashint8extended(val2 as i64));
+
+            let val32 = val as u32;
+            assert_eq!(
+                core_hash_bytes_uint32_extended(val32),
+                plugin_hash_bytes_uint32_extended(val32)
+            );
+
+            let combined = splitmix64(&mut state);
+            assert_eq!(
+                core_hash_combine64(combined, val as u64),
+                plugin_hash_combine64(combined, val as u64)
+            );
+            for shards in [1, 2, 3, 16, 255] {
+                assert_eq!(
+                    core_shard_for_key(combined, shards),
+                    plugin_shard_for_key(combined, shards)
+                );
+            }
+        }
+        checked += 6;
+    }
+
+    // Batch variants (AVX2 where available) against scalar, across
+    // both copies, with remainders that don't fill a vector.
+    for n in [1usize, 3, 4, 7, 1009] {
+        let mut state = n as u64;
+        let vals = (0..n).map(|_| splitmix64(&mut state) as i64).collect::<Vec<_>>();
+        let mut core_out = vec![0u64; n];
+        let mut plugin_out = vec![0u64; n];
+        unsafe {
+            core_hashint8extended_batch(vals.as_ptr(), core_out.as_mut_ptr(), n as i32);
+            plugin_hashint8extended_batch(vals.as_ptr(), plugin_out.as_mut_ptr(), n as i32);
+        }
+        for i in 0..n {
+            assert_eq!(core_out[i], plugin_out[i]);
+            assert_eq!(core_out[i], unsafe { core_hashint8extended(vals[i]) });
+        }
+
+        let keys = (0..n)
+            .map(|i| key_material(8 + i % 32, i as u64))
+            .collect::<Vec<_>>();
+        let ptrs = keys.iter().map(|key| key.as_ptr()).collect::<Vec<_>>();
+        let lens = keys.iter().map(|key| key.len() as i32).collect::<Vec<_>>();
+        unsafe {
+            core_hash_bytes_extended_batch(ptrs.as_ptr(), lens.as_ptr(), core_out.as_mut_ptr(), n as i32);
+            plugin_hash_bytes_extended_batch(ptrs.as_ptr(), lens.as_ptr(), plugin_out.as_mut_ptr(), n as i32);
+        }
+        for i in 0..n {
+            assert_eq!(core_out[i], plugin_out[i]);
+            assert_eq!(core_out[i], unsafe {
+                core_hash_bytes_extended(keys[i].as_ptr(), keys[i].len() as i32)
+            });
+        }
+        checked += 2 * n;
+    }
+
+    checked
+}
+
+/// Check both copies against hashes computed by a real PostgreSQL
+/// instance. Returns the number of vectors checked.
+fn verify_golden(path: &str) -> usize {
+    let mut checked = 0;
+
+    for line in read_to_string(path).expect("read golden vectors").lines() {
+        let line = line.trim();
+        if line.is_empty() {
+            continue;
+        }
+
+        let vector: serde_json::Value = serde_json::from_str(line).expect("golden vector JSON");
+        // Postgres reports the hash as a signed bigint.
+        let expected = vector["hash"].as_i64().expect("hash field") as u64;
+
+        let actual = if let Some(hex) = vector["key"].as_str() {
+            let key = (0..hex.len())
+                .step_by(2)
+                .map(|i| u8::from_str_radix(&hex[i..i + 2], 16).expect("hex key"))
+                .collect::<Vec<_>>();
+            let (core, plugin) = unsafe {
+                (
+                    core_hash_bytes_extended(key.as_ptr(), key.len() as i32),
+                    plugin_hash_bytes_extended(key.as_ptr(), key.len() as i32),
+                )
+            };
+            assert_eq!(core, plugin);
+            core
+        } else if let Some(val) = vector["int8"].as_i64() {
+            let (core, plugin) =
+                unsafe { (core_hashint8extended(val), plugin_hashint8extended(val)) };
+            assert_eq!(core, plugin);
+            core
+        } else {
+            panic!("golden vector needs a \"key\" or \"int8\" field: {}", line);
+        };
+
+        assert_eq!(actual, expected, "drift from PostgreSQL: {}", line);
+        checked += 1;
+    }
+
+    checked
+}
+
+/// GB/s per key-size bucket, for both copies.
+fn throughput(keys_per_bucket: usize) {
+    println!();
+    println!(
+        "{:>8} {:>12} {:>12} {:>14}",
+        "key", "core GB/s", "plugin GB/s", "core batch GB/s"
+    );
+
+    for len in [8usize, 16, 64, 256, 1024] {
+        let keys = (0..keys_per_bucket.min(1 << 20))
+            .map(|i| key_material(len, i as u64))
+            .collect::<Vec<_>>();
+        let bytes = (keys.len() * len) as f64;
+
+        let gbs = |elapsed: std::time::Duration| bytes / elapsed.as_secs_f64() / 1e9;
+
+        let started = Instant::now();
+        let mut sink = 0u64;
+        for key in &keys {
+            sink ^= unsafe { core_hash_bytes_extended(key.as_ptr(), len as i32) };
+        }
+        let core = gbs(started.elapsed());
+
+        let started = Instant::now();
+        for key in &keys {
+            sink ^= unsafe { plugin_hash_bytes_extended(key.as_ptr(), len as i32) };
+        }
+        let plugin = gbs(started.elapsed());
+
+        let ptrs = keys.iter().map(|key| key.as_ptr()).collect::<Vec<_>>();
+        let lens = vec![len as i32; keys.len()];
+        let mut out = vec![0u64; keys.len()];
+        let started = Instant::now();
+        unsafe {
+            core_hash_bytes_extended_batch(
+                ptrs.as_ptr(),
+                lens.as_ptr(),
+                out.as_mut_ptr(),
+                keys.len() as i32,
+            );
+        }
+        let batch = gbs(started.elapsed());
+        sink ^= out[0];
+
+        println!(
+            "{:>6}B {:>12.2} {:>12.2} {:>14.2}   (sink {:x})",
+            len, core, plugin, batch, sink & 0xf
+        );
+    }
+}
+
+fn main() {
+    let args = Args::parse();
+
+    let checked = verify_copies();
+    println!("copies agree: {} comparisons, 0 drifts", checked);
+
+    if let Some(golden) = &args.golden {
+        let checked = verify_golden(golden);
+        println!("golden vectors: {} checked, 0 drifts", checked);
+    } else {
+        println!("golden vectors: skipped (pass --golden vectors.jsonl)");
+    }
+
+    throughput(args.throughput_keys);
+}
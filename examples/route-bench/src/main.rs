@@ -0,0 +1,211 @@
+//! Benchmark a plugin's pgdog_route_query in isolation.
+//!
+//! Loads the plugin shared library the same way pgDog does, replays
+//! a recorded workload and reports ns/call, allocations/call and p99
+//! latency across configurable thread counts. Useful for validating
+//! plugin changes before they hit production and for catching
+//! routing-latency regressions between releases.
+//!
+//! ```bash
+//! cargo run --release -p route-bench -- routing_plugin workload.jsonl --threads 1,4,8
+//! ```
+//!
+//! The workload file has one JSON object per line with a "query"
+//! field. Lines that aren't JSON are treated as raw SQL, so plain
+//! one-statement-per-line files work too.
+
+use clap::Parser;
+use pgdog_plugin::bindings::{Config, DatabaseConfig, Input, Role_PRIMARY, RoutingInput};
+use pgdog_plugin::{Plugin, Query};
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::ffi::CString;
+use std::fs::read_to_string;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::Instant;
+
+/// System allocator wrapped with an allocation counter.
+///
+/// Counts allocations made by this process's Rust allocator: the
+/// harness and anything pgDog would allocate per routing call.
+/// malloc traffic internal to the plugin's shared library isn't
+/// visible here.
+struct CountingAllocator;
+
+static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        System.alloc(layout)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAllocator = CountingAllocator;
+
+#[derive(Parser)]
+#[command(about = "Benchmark pgdog_route_query against a recorded workload")]
+struct Cli {
+    /// Plugin name, resolved like pgDog resolves plugins:
+    /// lib<name>.so in the library search path.
+    plugin: String,
+
+    /// Workload file: one JSON object per line with a "query" field.
+    workload: String,
+
+    /// Thread counts to benchmark.
+    #[arg(long, value_delimiter = ',', default_value = "1")]
+    threads: Vec<usize>,
+
+    /// Number of times each thread replays the workload.
+    #[arg(long, default_value = "100")]
+    iterations: usize,
+
+    /// Number of shards in the synthetic config.
+    #[arg(long, default_value = "4")]
+    shards: usize,
+}
+
+fn main() -> Result<(), Box<dyn std::error::Error>> {
+    let cli = Cli::parse();
+
+    let queries = workload(&cli.workload)?;
+    if queries.is_empty() {
+        return Err(format!("no queries in \"{}\"", cli.workload).into());
+    }
+
+    // The library and the config snapshot live for the whole run,
+    // same as in pgDog proper.
+    let library = Box::leak(Box::new(Plugin::library(&cli.plugin)?));
+    let plugin: &'static Plugin = Box::leak(Box::new(Plugin::load(&cli.plugin, library)));
+
+    if !plugin.valid() {
+        return Err(format!("plugin \"{}\" is missing required symbols", cli.plugin).into());
+    }
+
+    plugin.init();
+
+    let databases = (0..cli.shards)
+        .map(|shard| {
+            DatabaseConfig::new(
+                CString::new("127.0.0.1").unwrap(),
+                5432,
+                Role_PRIMARY,
+                shard,
+            )
+        })
+        .collect::<Vec<_>>();
+    let config: &'static Config = Box::leak(Box::new(Config::new(
+        CString::new("route-bench").unwrap(),
+        &databases,
+        cli.shards,
+    )));
+    plugin.config_update(config, 1);
+
+    println!(
+        "{} queries, {} iterations/thread, {} shards",
+        queries.len(),
+        cli.iterations,
+        cli.shards
+    );
+    println!(
+        "{:>8} {:>12} {:>12} {:>14} {:>12}",
+        "threads", "calls", "ns/call", "allocs/call", "p99 (ns)"
+    );
+
+    for &threads in &cli.threads {
+        run(plugin, &queries, threads, cli.iterations);
+    }
+
+    plugin.fini();
+
+    Ok(())
+}
+
+/// Replay the workload on the given number of threads and report
+/// per-call latency and allocation counts.
+fn run(plugin: &'static Plugin, queries: &[String], threads: usize, iterations: usize) {
+    let allocations = ALLOCATIONS.load(Ordering::Relaxed);
+
+    let mut latencies = std::thread::scope(|scope| {
+        let handles = (0..threads)
+            .map(|_| {
+                scope.spawn(move || {
+                    // Queries are marshalled once per thread; the
+                    // timed region is just the routing call, like
+                    // pgDog's own hot path.
+                    let mut requests = queries
+                        .iter()
+                        .map(|query| Query::new(CString::new(query.as_str()).unwrap()))
+                        .collect::<Vec<_>>();
+
+                    let mut latencies = Vec::with_capacity(queries.len() * iterations);
+
+                    for _ in 0..iterations {
+                        for query in &requests {
+                            let input = Input::new_query(1, RoutingInput::query(*query));
+
+                            let start = Instant::now();
+                            let output = plugin.route(input);
+                            latencies.push(start.elapsed().as_nanos() as u64);
+
+                            if let Some(output) = output {
+                                unsafe { output.deallocate() };
+                            }
+                        }
+                    }
+
+                    for request in &mut requests {
+                        unsafe { request.deallocate() };
+                    }
+
+                    latencies
+                })
+            })
+            .collect::<Vec<_>>();
+
+        handles
+            .into_iter()
+            .flat_map(|handle| handle.join().unwrap())
+            .collect::<Vec<_>>()
+    });
+
+    let allocations = ALLOCATIONS.load(Ordering::Relaxed) - allocations;
+
+    latencies.sort_unstable();
+    let calls = latencies.len();
+    let mean = latencies.iter().sum::<u64>() as f64 / calls as f64;
+    let p99 = latencies[(calls - 1).min(calls * 99 / 100)];
+
+    println!(
+        "{:>8} {:>12} {:>12.0} {:>14.2} {:>12}",
+        threads,
+        calls,
+        mean,
+        allocations as f64 / calls as f64,
+        p99
+    );
+}
+
+/// Load queries from the workload file.
+fn workload(path: &str) -> Result<Vec<String>, std::io::Error> {
+    Ok(read_to_string(path)?
+        .lines()
+        .filter(|line| !line.trim().is_empty())
+        .filter_map(|line| {
+            match serde_json::from_str::<serde_json::Value>(line) {
+                Ok(value) => value
+                    .get("query")
+                    .and_then(|query| query.as_str())
+                    .map(|query| query.to_owned()),
+                // Not JSON: treat the line as raw SQL.
+                Err(_) => Some(line.to_owned()),
+            }
+        })
+        .collect())
+}
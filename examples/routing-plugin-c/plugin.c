@@ -1,36 +1,35 @@
 
 #include <stdio.h>
-#include <string.h>
-#include <ctype.h>
-#include <stdlib.h>
 #include "../../pgdog-plugin/include/plugin.h"
 
+/* ABI version this plugin was compiled against. */
+int pgdog_api_version() {
+    return PGDOG_API_VERSION;
+}
+
 void pgdog_init() {
     printf("pgDog routing in C initialized\n");
 }
 
 Output pgdog_route_query(Input input) {
-    Output plugin_output;
+    /* Zero the whole struct: pgDog reads the cache and arena
+     * fields, which must not be garbage. */
+    Output plugin_output = { 0 };
     RoutingOutput routing_output;
     Route route;
-    char *lowercase;
 
     route.shard = ANY; /* No sharding */
 
-    lowercase = strdup(input.input.query.query);
-
-    for (int i = 0; i < strlen(lowercase); i++) {
-        lowercase[i] = tolower(lowercase[i]);
-    }
-
-    if (!strncmp(lowercase, "select", strlen("select"))) {
+    /* One pass over the query text, no allocation. */
+    switch (pgdog_query_verb(input.input.query.query, input.input.query.len)) {
+    case STATEMENT_SELECT:
         route.affinity = READ;
-    } else {
+        break;
+    default:
         route.affinity = WRITE;
+        break;
     }
 
-    free(lowercase);
-
     routing_output.route = route;
     plugin_output.decision = FORWARD;
     plugin_output.output = routing_output;
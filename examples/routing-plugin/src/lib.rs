@@ -1,12 +1,18 @@
 //! Simple routing plugin example using Rust.
 use pgdog_plugin::*;
 
+/// ABI version this plugin was compiled against.
+#[no_mangle]
+pub extern "C" fn pgdog_api_version() -> std::ffi::c_int {
+    PGDOG_API_VERSION as std::ffi::c_int
+}
+
 /// Route query.
 #[no_mangle]
 pub extern "C" fn pgdog_route_query(input: Input) -> Output {
     let is_read = input
         .query()
-        .map(|query| query.query().to_lowercase().trim().starts_with("select"))
+        .map(|query| query_verb(query.query().as_bytes()) == StatementKind_STATEMENT_SELECT)
         .unwrap_or(false);
 
     // This is just an example of extracing a parameter from
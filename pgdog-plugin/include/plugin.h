@@ -1,6 +1,27 @@
 
 #include "types.h"
 
+/*
+ * Report the ABI version the plugin was compiled against.
+ *
+ * Required as of PGDOG_API_VERSION 2: return PGDOG_API_VERSION.
+ * The symbol was introduced together with a struct layout change,
+ * so pgDog refuses to load plugins that don't export it — or that
+ * report a different version — instead of crashing on a layout
+ * mismatch.
+ */
+int pgdog_api_version(void);
+
+/*
+ * Advertise optional calling conventions the plugin supports,
+ * as a bitmask of PGDOG_CAP_* values.
+ *
+ * Implementing this function is optional. Plugins without it are
+ * probed by symbol presence alone; plugins with it are only called
+ * through conventions they advertise.
+ */
+uint64_t pgdog_capabilities(void);
+
 /* Route query to a primary/replica and shard.
  *
  * Implementing this function is optional. If the plugin
@@ -18,9 +39,52 @@
  * This function is called for every transaction. It's a hot path,
  * so make sure to optimize for performance in the implementation.
  *
+ * ## Lifetime
+ *
+ * The Input and everything it references — query text, parameters,
+ * pre-parsed metadata — are only valid for the duration of this
+ * call, including when the plugin returns PENDING. Copy whatever an
+ * asynchronous lookup needs before returning; only the context
+ * pointer may be carried into the completion callback. (The
+ * CopyInput data buffer has its own, longer guarantee; see
+ * CopyInput.)
+ *
 */
 Output pgdog_route_query(Input input);
 
+/* Route a batch of queries in one call.
+ *
+ * Implementing this function is optional. If the plugin implements it,
+ * pgDog will pass pipelined queries to the plugin in batches instead of
+ * calling pgdog_route_query once per query. The plugin writes a routing
+ * decision for inputs[i] into outputs[i], for each of the n entries.
+ *
+ * ## Performance
+ *
+ * Each FFI crossing pays the cost of marshalling the Input struct. For
+ * pipelined workloads that send many queries per connection, batching
+ * amortizes that overhead across the whole pipeline.
+ *
+ * Thread safety requirements are the same as pgdog_route_query.
+ *
+*/
+void pgdog_route_query_batch(const Input *inputs, Output *outputs, int n);
+
+/*
+ * Receive a new cluster config snapshot.
+ *
+ * Implementing this function is optional. pgDog calls it once at
+ * plugin load time and again whenever the topology changes, before
+ * any queries are routed against the new configuration. The snapshot
+ * is immutable and stays valid until the plugin is unloaded, so it's
+ * safe to cache the pointer instead of copying the structure.
+ *
+ * The generation number identifies the snapshot; Input carries the
+ * generation that was current when the query arrived. This replaces
+ * marshalling a full Config on every routing call.
+ */
+void pgdog_config_update(const Config *config, uint64_t generation);
+
 /*
  * Perform initialization at plugin loading time.
  *
@@ -30,6 +94,21 @@ Output pgdog_route_query(Input input);
  */
 void pgdog_init();
 
+/*
+ * Perform per-thread initialization.
+ *
+ * Implementing this function is optional. pgDog invokes it once on
+ * each runtime thread before any queries are routed on it, so the
+ * plugin can set up thread-local caches, arenas and statistics
+ * slots and run lock-free in pgdog_route_query afterwards.
+ *
+ * thread_id starts at 0 and increases with every thread the runtime
+ * spawns; num_threads is the size of the worker pool configured at
+ * startup. Threads spawned for background work may receive ids
+ * larger than num_threads - 1; they don't route queries.
+ */
+void pgdog_init_thread(int thread_id, int num_threads);
+
 /* Create new row.
 *
 * Implemented by pgdog_plugin library.
@@ -43,3 +122,193 @@ extern Row pgdog_row_new(int num_columns);
 * Make sure your plugin links with -lpgdog_plugin.
 */
 extern void pgdog_row_free(Row row);
+
+/* Decode a parameter as a 64-bit integer.
+*
+* Handles both text and binary format (big-endian, int2/int4/int8
+* widths) without intermediate allocation, so the value can feed
+* straight into hashint8extended. Returns 1 and writes the value
+* on success, 0 if the parameter isn't an integer.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern int pgdog_param_as_int8(const Parameter *param, int64_t *value);
+
+/* Decode a parameter as a 32-bit integer.
+*
+* Same contract as pgdog_param_as_int8.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern int pgdog_param_as_int4(const Parameter *param, int32_t *value);
+
+/* Decode a parameter as a UUID.
+*
+* Binary values are the 16 raw bytes; text values are parsed as
+* hex, with or without dashes. Writes 16 bytes in network order,
+* ready for hash_bytes_extended. Returns 1 on success, 0 if the
+* parameter isn't a UUID.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern int pgdog_param_as_uuid(const Parameter *param, uint8_t *bytes);
+
+/* Classify the leading SQL keyword of a query.
+*
+* Skips whitespace and comments, then matches SELECT/INSERT/UPDATE/
+* DELETE/BEGIN/COMMIT case-insensitively in one pass with no
+* allocation. Pass -1 for len if the query is NUL-terminated.
+* Returns STATEMENT_UNKNOWN for anything else.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern StatementKind pgdog_query_verb(const char *query, int len);
+
+/* Register an error the plugin intends to return.
+*
+* Call at pgdog_init() time. Returns an id the plugin puts into a
+* StaticError output; the rejection path then allocates nothing.
+* The error registers in the host's registry (see
+* pgdog_install_host_api), the one pgDog resolves StaticError ids
+* in. detail may be NULL. Returns -1 if a required argument is
+* NULL. Registered errors live until the process exits.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern int pgdog_error_register(
+    const char *severity, const char *code, const char *message, const char *detail);
+
+/* Pre-encode an intercepted result into wire bytes.
+*
+* Produces the RowDescription and DataRow messages the client
+* will receive, ready to send as-is. Build the buffer once in
+* pgdog_init() (or cache it per result), set it on the Intercept
+* with its length, and pgDog's send path becomes a single
+* vectored write instead of re-framing the rows per response.
+* The buffer is freed by pgDog after the result has been sent.
+* Returns NULL if any argument is NULL.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern char *pgdog_row_preencode(
+    const RowDescription *row_description, const Row *rows, int num_rows, unsigned long *len);
+
+/* Memory-map a shard directory file: a sorted, fixed-width
+* (key, shard) file for range and list sharded tables too large
+* for a per-process hash table. Startup is an mmap, the memory
+* is shared across processes via the page cache, and lookups are
+* a branchless binary search.
+*
+* Open once in pgdog_init(); the handle is safe to share across
+* threads. Returns NULL if the file can't be opened or isn't a
+* shard map.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern void *pgdog_shardmap_open(const char *path);
+
+/* Look up the shard for a key in a shard directory.
+*
+* Returns the shard, or -1 if the key isn't in the directory.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern int pgdog_shardmap_lookup(const void *map, int64_t key);
+
+/* Unmap a shard directory. The handle must not be used after.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern void pgdog_shardmap_close(void *map);
+
+/* Get a statistics counter slot by name, registering it on
+* first use.
+*
+* The slot is a cacheline-padded atomic u64, valid for the life
+* of the process. Increment it with a relaxed atomic add, e.g.
+* __atomic_fetch_add(slot, 1, __ATOMIC_RELAXED): no locks, no
+* syscalls, no false sharing. Slots live in the host's registry
+* (see pgdog_install_host_api), which pgDog aggregates into its
+* stats surface. Resolve slots in pgdog_init() and cache the
+* pointers. Returns NULL if name is NULL.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern uint64_t *pgdog_stats_counter(const char *name);
+
+/* Install the host's registry entry points.
+*
+* Called by pgDog when it loads the plugin, before pgdog_init().
+* Every binary linking pgdog_plugin carries its own copy of the
+* registries; after this call the plugin's copy forwards to the
+* host's, so counters the plugin registers show up in pgDog's
+* stats surface. Plugins never call this themselves.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern void pgdog_install_host_api(HostApi api);
+
+/* Push a row into the COPY ring.
+*
+* Returns 1 on success, 0 if the ring is full. The row's data
+* pointer should point into the CopyInput buffer; the slot is
+* reused after pgDog drains it.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern int pgdog_copy_ring_push(CopyRing *ring, CopyRow row);
+
+/* Create new allocation arena.
+*
+* Allocations made from the arena are freed all at once,
+* either by pgdog_arena_reset or by pgdog_arena_free. Set the
+* arena on the Output and pgDog will free it after the result
+* has been sent, instead of deallocating rows, column buffers
+* and strings one by one.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern void *pgdog_arena_new();
+
+/* Allocate memory from the arena.
+*
+* The returned pointer is aligned like malloc(3) and remains
+* valid until the arena is reset or freed. Returns NULL only
+* if the arena itself is NULL.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern void *pgdog_arena_alloc(void *arena, unsigned long size);
+
+/* Free all allocations made from the arena, keeping the arena
+* itself around for reuse. Useful for plugins that keep a
+* per-thread arena across queries.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern void pgdog_arena_reset(void *arena);
+
+/* Free the arena and everything allocated from it.
+*
+* Called by pgDog on arenas attached to an Output. Plugins only
+* call this for arenas they keep for themselves.
+*
+* Implemented by pgdog_plugin library.
+* Make sure your plugin links with -lpgdog_plugin.
+*/
+extern void pgdog_arena_free(void *arena);
@@ -1,4 +1,26 @@
 
+#include <stdint.h>
+
+/**
+ * ABI version of this header.
+ *
+ * Bumped whenever a struct layout or calling convention changes.
+ * Plugins return it from pgdog_api_version() so pgDog can refuse
+ * to load a plugin built against a different layout instead of
+ * crashing on a mismatch.
+*/
+#define PGDOG_API_VERSION 2
+
+/**
+ * Optional calling conventions a plugin can advertise through
+ * pgdog_capabilities(). pgDog selects the fastest convention both
+ * sides support at load time.
+*/
+#define PGDOG_CAP_ROUTE_BATCH 0x1 /* implements pgdog_route_query_batch */
+#define PGDOG_CAP_ARENA_OUTPUT 0x2 /* returns arena-backed outputs */
+#define PGDOG_CAP_COPY_BINARY 0x4 /* understands binary format COPY input */
+#define PGDOG_CAP_COPY_BORROWED 0x8 /* CopyRow output borrows from the input buffer */
+
 /**
  * Query parameter value.
  */
@@ -8,10 +30,50 @@ typedef struct Parameter {
     int format;
 } Parameter;
 
+/**
+ * Statement kind, precomputed by pgDog's parser.
+ *
+ * STATEMENT_UNKNOWN means the metadata wasn't computed and the
+ * plugin has to parse the query itself.
+*/
+typedef enum StatementKind {
+    STATEMENT_UNKNOWN = 0,
+    STATEMENT_SELECT = 1,
+    STATEMENT_INSERT = 2,
+    STATEMENT_UPDATE = 3,
+    STATEMENT_DELETE = 4,
+    STATEMENT_OTHER = 5,
+    STATEMENT_BEGIN = 6,
+    STATEMENT_COMMIT = 7,
+} StatementKind;
+
+/**
+ * Equality predicate on the sharding column, extracted from the
+ * WHERE clause by pgDog's parser.
+*/
+typedef struct ShardingKeyPredicate {
+    /* Length of the value. 0 if the value is a bound parameter. */
+    int len;
+
+    /* Value as it appears in the query text, e.g. "5" or "'abc'".
+     * NULL if the value is a bound parameter. */
+    const char *value;
+
+    /* 0-based index of the bound parameter holding the value,
+     * -1 if the value is inline in the query text. */
+    int parameter;
+} ShardingKeyPredicate;
+
 /* Query and parameters received by pgDog.
  *
  * The plugin is expected to parse the query and based on its
  * contents and the parameters, make a routing decision.
+ *
+ * pgDog's router parses the statement before consulting plugins,
+ * so the query also carries pre-parsed metadata: the statement
+ * kind, the first table referenced and equality predicates on the
+ * sharding column. Plugins can use these instead of tokenizing
+ * the query text again.
  */
 typedef struct Query {
     /* Length of the query */
@@ -25,8 +87,38 @@ typedef struct Query {
 
     /* List of parameters. */
     const Parameter *parameters;
+
+    /* 64-bit statement fingerprint, e.g. a hash of the normalized
+     * query text. 0 if the caller didn't compute one. pgDog uses it
+     * to memoize routing decisions for repeat statements. */
+    uint64_t fingerprint;
+
+    /* Statement kind, STATEMENT_UNKNOWN if not precomputed. */
+    StatementKind statement_kind;
+
+    /* First table referenced by the statement, NULL if none. */
+    const char *table_name;
+
+    /* Number of sharding key predicates. */
+    int num_sharding_key_predicates;
+
+    /* Equality predicates on the sharding column found in the
+     * WHERE clause. */
+    const ShardingKeyPredicate *sharding_key_predicates;
 } Query;
 
+/**
+ * A pipeline of statements sent by the client in one batch
+ * (extended protocol Parse/Bind/Execute). Routed with a single
+ * plugin call that returns one route per statement, so the plugin
+ * can amortize its per-call cost and keep the whole pipeline on
+ * one shard to preserve ordering.
+*/
+typedef struct Pipeline {
+    int num_queries;
+    const Query *queries;
+} Pipeline;
+
 /**
  * The query is a read or a write.
  * In case the plugin isn't able to figure it out, it can return UNKNOWN and
@@ -59,13 +151,33 @@ typedef enum OrderByDirection {
     DESCENDING,
 } OrderByDirection;
 
+/*
+ * Data type of an ORDER BY sort key.
+ *
+ * ORDER_BY_UNKNOWN means the plugin didn't resolve the type and
+ * pgDog decodes column values generically.
+*/
+typedef enum OrderByType {
+    ORDER_BY_UNKNOWN = 0,
+    ORDER_BY_INT8 = 1,
+    ORDER_BY_INT4 = 2,
+    ORDER_BY_FLOAT8 = 3,
+    ORDER_BY_TEXT = 4,
+} OrderByType;
+
 /*
  * Column sorting.
+ *
+ * Plugins that resolved the sort column should return column_index
+ * with a data_type tag and leave column_name NULL: pgDog then merges
+ * sorted shard streams comparing binary values directly, without
+ * resolving names per row.
 */
 typedef struct OrderBy {
     char *column_name;
     int column_index;
     OrderByDirection direction;
+    OrderByType data_type;
 } OrderBy;
 
 /**
@@ -103,6 +215,10 @@ typedef enum RoutingDecision {
                  the next plugin in the chain. */
     COPY = 6, /* COPY */
     COPY_ROWS = 7, /* Copy rows. */
+    FORWARD_PIPELINE = 8, /* One route per statement of a pipeline. */
+    ERROR_STATIC = 9, /* An error registered with pgdog_error_register. */
+    PENDING = 10, /* The route will be delivered through the completion
+                 callback when the plugin's lookup finishes. */
 } RoutingDecision;
 
 /*
@@ -116,6 +232,16 @@ typedef struct Error {
     char *detail;
 } Error;
 
+/*
+ * Reference to an error registered with pgdog_error_register at
+ * pgdog_init() time. Returning one allocates nothing on the
+ * rejection path and pgDog encodes the ErrorResponse wire message
+ * for each id only once.
+*/
+typedef struct StaticError {
+    int id;
+} StaticError;
+
 typedef struct RowColumn {
     int length;
     char *data;
@@ -141,6 +267,13 @@ typedef struct Intercept {
     RowDescription row_description;
     int num_rows;
     Row *rows;
+
+    /* Wire-ready bytes for the whole result, produced by
+     * pgdog_row_preencode. When set, pgDog sends them with a single
+     * vectored write and ignores row_description/rows, skipping the
+     * text-encode and re-framing passes entirely. */
+    unsigned long encoded_len;
+    char *encoded;
 } Intercept;
 
 /**
@@ -150,6 +283,10 @@ typedef struct Intercept {
 typedef enum CopyFormat {
     INVALID,
     CSV,
+    /* Postgres binary COPY: length-prefixed tuples, no text
+     * conversion. The sharding key is read as a fixed-width
+     * big-endian field straight out of the tuple. */
+    BINARY,
 } CopyFormat;
 
 /**
@@ -174,6 +311,14 @@ typedef struct CopyRow {
     int len;
     char *data;
     int shard;
+
+    /* When set, data points into the CopyInput buffer instead of
+     * memory the plugin allocated. pgDog keeps the input buffer
+     * alive until the output has been processed (see CopyInput) and
+     * writes the row to its shard straight out of the buffer with
+     * vectored I/O, so sharding a COPY scatters pointers instead of
+     * copying bytes. Borrowed rows are never freed individually. */
+    int borrowed;
 } CopyRow;
 
 /**
@@ -187,6 +332,41 @@ typedef struct CopyOutput {
     char *header;
 } CopyOutput;
 
+/**
+ * Ring of reusable CopyRow slots for streaming COPY.
+ *
+ * pgDog allocates the ring once per COPY statement and reuses it
+ * across chunks, so large loads don't allocate and free a fresh
+ * CopyRow array per chunk. The plugin is the only writer of head;
+ * pgDog is the only writer of tail. Both indexes grow monotonically
+ * and are wrapped with `& (capacity - 1)` when indexing slots, so
+ * pgDog can drain completed slots to backends while the plugin is
+ * still filling the rest.
+ *
+ * <div rustbindgen nodebug></div>
+*/
+typedef struct CopyRing {
+    /* Number of slots. Always a power of two. */
+    int capacity;
+
+    /* Slot storage, allocated by pgDog. */
+    CopyRow *slots;
+
+    /* Index of the next slot the plugin fills. */
+    uint64_t head;
+
+    /* Index of the next slot pgDog drains. */
+    uint64_t tail;
+} CopyRing;
+
+/**
+ * One route per statement of a pipeline, in statement order.
+*/
+typedef struct PipelineOutput {
+    int num_routes;
+    Route *routes;
+} PipelineOutput;
+
 /*
  * Union of results a plugin can return.
  *
@@ -198,9 +378,11 @@ typedef struct CopyOutput {
 typedef union RoutingOutput {
     Route route;
     Error error;
+    StaticError static_error;
     Intercept intercept;
     Copy copy;
     CopyOutput copy_rows;
+    PipelineOutput pipeline;
 } RoutingOutput;
 
 /*
@@ -211,6 +393,20 @@ typedef union RoutingOutput {
 typedef struct Output {
     RoutingDecision decision;
     RoutingOutput output;
+
+    /* How long pgDog may reuse this decision for queries with the
+     * same fingerprint, in milliseconds. 0 (the default) disables
+     * caching; negative values cache the decision until the plugin
+     * is reloaded. FORWARD routes are memoized as-is; for INTERCEPT
+     * results pgDog caches the encoded wire bytes and answers repeat
+     * queries directly, without calling the plugin at all. */
+    int cache_ttl_ms;
+
+    /* Arena the memory in this output was allocated from, if any.
+     * Created with pgdog_arena_new(). When set, pgDog frees the
+     * whole output (rows, column buffers, strings) by freeing the
+     * arena in one shot instead of walking the structures. */
+    void *arena;
 } Output;
 
 /**
@@ -243,8 +439,27 @@ typedef struct Config {
     int shards;
 } Config;
 
+/**
+ * Byte spans of one row inside the CopyInput buffer, precomputed
+ * by pgDog's vectorized pre-scan. Offsets are relative to data.
+ * The row span excludes the trailing newline; the key span covers
+ * the sharding column field, with surrounding quotes stripped.
+*/
+typedef struct CopyRowSpan {
+    int row_start;
+    int row_len;
+    int key_start;
+    int key_len;
+} CopyRowSpan;
+
 /**
  * Copy input.
+ *
+ * The data buffer outlives the plugin call: pgDog keeps it alive
+ * until every row produced from it — batch CopyOutput or streaming
+ * ring slots — has been written to its shard. Plugins should return
+ * borrowed CopyRows pointing into it (and advertise
+ * PGDOG_CAP_COPY_BORROWED) instead of copying row bytes out.
 */
 typedef struct CopyInput {
     int len;
@@ -252,6 +467,28 @@ typedef struct CopyInput {
     char delimiter;
     int has_headers;
     int sharding_column;
+
+    /* Ring of reusable CopyRow slots for streaming mode. NULL in
+     * batch mode: the plugin then returns freshly allocated rows in
+     * a CopyOutput like before. In streaming mode the plugin fills
+     * slots in place, with row data pointing into the input buffer
+     * (zero-copy); pgDog keeps the buffer alive until every slot
+     * has been drained. Rows that don't fit because the ring is
+     * full are returned in the CopyOutput as a fallback. */
+    CopyRing *ring;
+
+    /* Row boundaries and sharding key spans, found by pgDog in one
+     * vectorized scan of the buffer. When set (num_rows > 0), the
+     * plugin can hash the key bytes directly instead of running its
+     * own byte-at-a-time CSV scanner. Includes the header row when
+     * has_headers is set. Owned by pgDog, valid for the call. */
+    int num_rows;
+    const CopyRowSpan *rows;
+
+    /* Data format. CSV unless the COPY statement asked for BINARY,
+     * in which case data holds length-prefixed binary tuples and
+     * delimiter/has_headers are meaningless. */
+    CopyFormat format;
 } CopyInput;
 
 /**
@@ -260,6 +497,7 @@ typedef struct CopyInput {
 typedef union RoutingInput {
     Query query;
     CopyInput copy;
+    Pipeline pipeline;
 } RoutingInput;
 
 /**
@@ -268,13 +506,69 @@ typedef union RoutingInput {
 typedef enum InputType {
     ROUTING_INPUT = 1,
     COPY_INPUT = 2,
+    PIPELINE_INPUT = 3,
 } InputType;
 
 /**
  * Plugin input.
+ *
+ * The cluster configuration is no longer marshalled on every call:
+ * plugins receive immutable Config snapshots through
+ * pgdog_config_update and the input only carries the generation
+ * number of the snapshot that was current when the query arrived.
 */
+/*
+ * Completion callback for PENDING decisions.
+ *
+ * A plugin that has to wait on external I/O (e.g. a remote shard
+ * directory) returns PENDING from pgdog_route_query and calls this
+ * callback, exactly once, when its lookup finishes. Only the
+ * waiting client is parked; the calling thread returns to routing
+ * other connections immediately. The callback is safe to call from
+ * any thread. context is the value from the Input the decision was
+ * made for.
+ *
+ * The Input and everything it references are only valid for the
+ * duration of the pgdog_route_query call — PENDING included: pgDog
+ * may free them as soon as the call returns. A plugin that routes
+ * asynchronously must copy whatever its lookup needs before
+ * returning; only context may be carried into the callback.
+*/
+typedef void (*RouteComplete)(void *context, Output output);
+
+/**
+ * Entry points into the host's registries.
+ *
+ * The pgdog_plugin library is linked into every binary separately —
+ * pgDog itself, Rust plugins that embed the crate, C plugins that
+ * link the shared library — so each binary carries its own copy of
+ * the registries. pgDog installs these pointers into every plugin
+ * at load time through pgdog_install_host_api; the plugin-side
+ * helpers then forward registrations to the host's copy, which is
+ * the one pgDog reads.
+*/
+typedef struct HostApi {
+    /* The host's pgdog_stats_counter: slots it returns are the
+     * ones aggregated into pgDog's stats surface. */
+    uint64_t *(*stats_counter)(const char *name);
+
+    /* The host's pgdog_error_register: ids it returns resolve in
+     * the host's registry, the one pgDog looks ERROR_STATIC
+     * outputs up in. */
+    int (*error_register)(
+        const char *severity, const char *code, const char *message, const char *detail);
+} HostApi;
+
 typedef struct Input {
-    Config config;
+    /* Generation number of the current config snapshot. */
+    uint64_t config_generation;
     InputType input_type;
     RoutingInput input;
+
+    /* Completion callback for PENDING decisions and the value to
+     * call it with. NULL when pgDog can't handle an asynchronous
+     * decision for this input; the plugin must then decide
+     * synchronously. */
+    RouteComplete complete;
+    void *context;
 } Input;
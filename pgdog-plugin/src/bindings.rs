@@ -1,5 +1,10 @@
 /* automatically generated by rust-bindgen 0.71.1 */
 
+pub const PGDOG_API_VERSION: u32 = 2;
+pub const PGDOG_CAP_ROUTE_BATCH: u32 = 1;
+pub const PGDOG_CAP_ARENA_OUTPUT: u32 = 2;
+pub const PGDOG_CAP_COPY_BINARY: u32 = 4;
+pub const PGDOG_CAP_COPY_BORROWED: u32 = 8;
 #[doc = " Query parameter value."]
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -16,6 +21,35 @@ const _: () = {
     ["Offset of field: Parameter::data"][::std::mem::offset_of!(Parameter, data) - 8usize];
     ["Offset of field: Parameter::format"][::std::mem::offset_of!(Parameter, format) - 16usize];
 };
+pub const StatementKind_STATEMENT_UNKNOWN: StatementKind = 0;
+pub const StatementKind_STATEMENT_SELECT: StatementKind = 1;
+pub const StatementKind_STATEMENT_INSERT: StatementKind = 2;
+pub const StatementKind_STATEMENT_UPDATE: StatementKind = 3;
+pub const StatementKind_STATEMENT_DELETE: StatementKind = 4;
+pub const StatementKind_STATEMENT_OTHER: StatementKind = 5;
+pub const StatementKind_STATEMENT_BEGIN: StatementKind = 6;
+pub const StatementKind_STATEMENT_COMMIT: StatementKind = 7;
+#[doc = " Statement kind, precomputed by pgDog's parser.\n\n STATEMENT_UNKNOWN means the metadata wasn't computed and the\n plugin has to parse the query itself."]
+pub type StatementKind = ::std::os::raw::c_uint;
+#[doc = " Equality predicate on the sharding column, extracted from the\n WHERE clause by pgDog's parser."]
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct ShardingKeyPredicate {
+    pub len: ::std::os::raw::c_int,
+    pub value: *const ::std::os::raw::c_char,
+    pub parameter: ::std::os::raw::c_int,
+}
+#[allow(clippy::unnecessary_operation, clippy::identity_op)]
+const _: () = {
+    ["Size of ShardingKeyPredicate"][::std::mem::size_of::<ShardingKeyPredicate>() - 24usize];
+    ["Alignment of ShardingKeyPredicate"][::std::mem::align_of::<ShardingKeyPredicate>() - 8usize];
+    ["Offset of field: ShardingKeyPredicate::len"]
+        [::std::mem::offset_of!(ShardingKeyPredicate, len) - 0usize];
+    ["Offset of field: ShardingKeyPredicate::value"]
+        [::std::mem::offset_of!(ShardingKeyPredicate, value) - 8usize];
+    ["Offset of field: ShardingKeyPredicate::parameter"]
+        [::std::mem::offset_of!(ShardingKeyPredicate, parameter) - 16usize];
+};
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct Query {
@@ -23,16 +57,44 @@ pub struct Query {
     pub query: *const ::std::os::raw::c_char,
     pub num_parameters: ::std::os::raw::c_int,
     pub parameters: *const Parameter,
+    pub fingerprint: u64,
+    pub statement_kind: StatementKind,
+    pub table_name: *const ::std::os::raw::c_char,
+    pub num_sharding_key_predicates: ::std::os::raw::c_int,
+    pub sharding_key_predicates: *const ShardingKeyPredicate,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of Query"][::std::mem::size_of::<Query>() - 32usize];
+    ["Size of Query"][::std::mem::size_of::<Query>() - 72usize];
     ["Alignment of Query"][::std::mem::align_of::<Query>() - 8usize];
     ["Offset of field: Query::len"][::std::mem::offset_of!(Query, len) - 0usize];
     ["Offset of field: Query::query"][::std::mem::offset_of!(Query, query) - 8usize];
     ["Offset of field: Query::num_parameters"]
         [::std::mem::offset_of!(Query, num_parameters) - 16usize];
     ["Offset of field: Query::parameters"][::std::mem::offset_of!(Query, parameters) - 24usize];
+    ["Offset of field: Query::fingerprint"][::std::mem::offset_of!(Query, fingerprint) - 32usize];
+    ["Offset of field: Query::statement_kind"]
+        [::std::mem::offset_of!(Query, statement_kind) - 40usize];
+    ["Offset of field: Query::table_name"][::std::mem::offset_of!(Query, table_name) - 48usize];
+    ["Offset of field: Query::num_sharding_key_predicates"]
+        [::std::mem::offset_of!(Query, num_sharding_key_predicates) - 56usize];
+    ["Offset of field: Query::sharding_key_predicates"]
+        [::std::mem::offset_of!(Query, sharding_key_predicates) - 64usize];
+};
+#[doc = " A pipeline of statements sent by the client in one batch\n (extended protocol Parse/Bind/Execute). Routed with a single\n plugin call that returns one route per statement, so the plugin\n can amortize its per-call cost and keep the whole pipeline on\n one shard to preserve ordering."]
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct Pipeline {
+    pub num_queries: ::std::os::raw::c_int,
+    pub queries: *const Query,
+}
+#[allow(clippy::unnecessary_operation, clippy::identity_op)]
+const _: () = {
+    ["Size of Pipeline"][::std::mem::size_of::<Pipeline>() - 16usize];
+    ["Alignment of Pipeline"][::std::mem::align_of::<Pipeline>() - 8usize];
+    ["Offset of field: Pipeline::num_queries"]
+        [::std::mem::offset_of!(Pipeline, num_queries) - 0usize];
+    ["Offset of field: Pipeline::queries"][::std::mem::offset_of!(Pipeline, queries) - 8usize];
 };
 pub const Affinity_READ: Affinity = 1;
 pub const Affinity_WRITE: Affinity = 2;
@@ -48,22 +110,31 @@ pub type Shard = ::std::os::raw::c_int;
 pub const OrderByDirection_ASCENDING: OrderByDirection = 0;
 pub const OrderByDirection_DESCENDING: OrderByDirection = 1;
 pub type OrderByDirection = ::std::os::raw::c_uint;
+pub const OrderByType_ORDER_BY_UNKNOWN: OrderByType = 0;
+pub const OrderByType_ORDER_BY_INT8: OrderByType = 1;
+pub const OrderByType_ORDER_BY_INT4: OrderByType = 2;
+pub const OrderByType_ORDER_BY_FLOAT8: OrderByType = 3;
+pub const OrderByType_ORDER_BY_TEXT: OrderByType = 4;
+#[doc = " Data type of an ORDER BY sort key.\n\n ORDER_BY_UNKNOWN means the plugin didn't resolve the type and\n pgDog decodes column values generically."]
+pub type OrderByType = ::std::os::raw::c_uint;
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct OrderBy {
     pub column_name: *mut ::std::os::raw::c_char,
     pub column_index: ::std::os::raw::c_int,
     pub direction: OrderByDirection,
+    pub data_type: OrderByType,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of OrderBy"][::std::mem::size_of::<OrderBy>() - 16usize];
+    ["Size of OrderBy"][::std::mem::size_of::<OrderBy>() - 24usize];
     ["Alignment of OrderBy"][::std::mem::align_of::<OrderBy>() - 8usize];
     ["Offset of field: OrderBy::column_name"]
         [::std::mem::offset_of!(OrderBy, column_name) - 0usize];
     ["Offset of field: OrderBy::column_index"]
         [::std::mem::offset_of!(OrderBy, column_index) - 8usize];
     ["Offset of field: OrderBy::direction"][::std::mem::offset_of!(OrderBy, direction) - 12usize];
+    ["Offset of field: OrderBy::data_type"][::std::mem::offset_of!(OrderBy, data_type) - 16usize];
 };
 #[doc = " Route the query should take."]
 #[repr(C)]
@@ -90,6 +161,9 @@ pub const RoutingDecision_INTERCEPT: RoutingDecision = 4;
 pub const RoutingDecision_NO_DECISION: RoutingDecision = 5;
 pub const RoutingDecision_COPY: RoutingDecision = 6;
 pub const RoutingDecision_COPY_ROWS: RoutingDecision = 7;
+pub const RoutingDecision_FORWARD_PIPELINE: RoutingDecision = 8;
+pub const RoutingDecision_ERROR_STATIC: RoutingDecision = 9;
+pub const RoutingDecision_PENDING: RoutingDecision = 10;
 #[doc = " The routing decision the plugin makes based on the query contents.\n\n FORWARD: The query is forwarded to a shard. Which shard (and whether it's a replica\n           or a primary) is decided by the plugin output.\n REWRITE: The query text is rewritten. The plugin outputs new query text.\n ERROR: The query is denied and the plugin returns an error instead. This error is sent\n        to the client.\n INTERCEPT: The query is intercepted and the plugin returns rows instead. These rows\nare sent to the client and the original query is never sent to a backend server.\n NO_DECISION: The plugin doesn't care about this query. The output is ignored by pgDog and the next\nplugin in the chain is attempted.\n COPY: Client is sending over a COPY statement."]
 pub type RoutingDecision = ::std::os::raw::c_uint;
 #[repr(C)]
@@ -109,6 +183,18 @@ const _: () = {
     ["Offset of field: Error::message"][::std::mem::offset_of!(Error, message) - 16usize];
     ["Offset of field: Error::detail"][::std::mem::offset_of!(Error, detail) - 24usize];
 };
+#[doc = " Reference to an error registered with pgdog_error_register at\n pgdog_init() time. Returning one allocates nothing on the\n rejection path and pgDog encodes the ErrorResponse wire message\n for each id only once."]
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct StaticError {
+    pub id: ::std::os::raw::c_int,
+}
+#[allow(clippy::unnecessary_operation, clippy::identity_op)]
+const _: () = {
+    ["Size of StaticError"][::std::mem::size_of::<StaticError>() - 4usize];
+    ["Alignment of StaticError"][::std::mem::align_of::<StaticError>() - 4usize];
+    ["Offset of field: StaticError::id"][::std::mem::offset_of!(StaticError, id) - 0usize];
+};
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct RowColumn {
@@ -174,18 +260,25 @@ pub struct Intercept {
     pub row_description: RowDescription,
     pub num_rows: ::std::os::raw::c_int,
     pub rows: *mut Row,
+    pub encoded_len: ::std::os::raw::c_ulong,
+    pub encoded: *mut ::std::os::raw::c_char,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of Intercept"][::std::mem::size_of::<Intercept>() - 32usize];
+    ["Size of Intercept"][::std::mem::size_of::<Intercept>() - 48usize];
     ["Alignment of Intercept"][::std::mem::align_of::<Intercept>() - 8usize];
     ["Offset of field: Intercept::row_description"]
         [::std::mem::offset_of!(Intercept, row_description) - 0usize];
     ["Offset of field: Intercept::num_rows"][::std::mem::offset_of!(Intercept, num_rows) - 16usize];
     ["Offset of field: Intercept::rows"][::std::mem::offset_of!(Intercept, rows) - 24usize];
+    ["Offset of field: Intercept::encoded_len"]
+        [::std::mem::offset_of!(Intercept, encoded_len) - 32usize];
+    ["Offset of field: Intercept::encoded"][::std::mem::offset_of!(Intercept, encoded) - 40usize];
 };
 pub const CopyFormat_INVALID: CopyFormat = 0;
 pub const CopyFormat_CSV: CopyFormat = 1;
+#[doc = " Postgres binary COPY: length-prefixed tuples, no text\n conversion. The sharding key is read as a fixed-width\n big-endian field straight out of the tuple."]
+pub const CopyFormat_BINARY: CopyFormat = 2;
 #[doc = " Copy format. Currently supported:\n  - CSV"]
 pub type CopyFormat = ::std::os::raw::c_uint;
 #[doc = " Client requesting a COPY."]
@@ -217,6 +310,8 @@ pub struct CopyRow {
     pub len: ::std::os::raw::c_int,
     pub data: *mut ::std::os::raw::c_char,
     pub shard: ::std::os::raw::c_int,
+    #[doc = " When set, data points into the CopyInput buffer instead of\n memory the plugin allocated. pgDog keeps the input buffer\n alive until the output has been processed (see CopyInput) and\n writes the row to its shard straight out of the buffer with\n vectored I/O, so sharding a COPY scatters pointers instead of\n copying bytes. Borrowed rows are never freed individually."]
+    pub borrowed: ::std::os::raw::c_int,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
@@ -225,6 +320,7 @@ const _: () = {
     ["Offset of field: CopyRow::len"][::std::mem::offset_of!(CopyRow, len) - 0usize];
     ["Offset of field: CopyRow::data"][::std::mem::offset_of!(CopyRow, data) - 8usize];
     ["Offset of field: CopyRow::shard"][::std::mem::offset_of!(CopyRow, shard) - 16usize];
+    ["Offset of field: CopyRow::borrowed"][::std::mem::offset_of!(CopyRow, borrowed) - 20usize];
 };
 #[doc = " Copy output.\n\n <div rustbindgen nodebug></div>"]
 #[repr(C)]
@@ -243,26 +339,70 @@ const _: () = {
     ["Offset of field: CopyOutput::rows"][::std::mem::offset_of!(CopyOutput, rows) - 8usize];
     ["Offset of field: CopyOutput::header"][::std::mem::offset_of!(CopyOutput, header) - 16usize];
 };
+#[doc = " Ring of reusable CopyRow slots for streaming COPY.\n\n pgDog allocates the ring once per COPY statement and reuses it\n across chunks, so large loads don't allocate and free a fresh\n CopyRow array per chunk. The plugin is the only writer of head;\n pgDog is the only writer of tail. Both indexes grow monotonically\n and are wrapped with `& (capacity - 1)` when indexing slots, so\n pgDog can drain completed slots to backends while the plugin is\n still filling the rest.\n\n <div rustbindgen nodebug></div>"]
+#[repr(C)]
+#[derive(Copy, Clone)]
+pub struct CopyRing {
+    #[doc = " Number of slots. Always a power of two."]
+    pub capacity: ::std::os::raw::c_int,
+    #[doc = " Slot storage, allocated by pgDog."]
+    pub slots: *mut CopyRow,
+    #[doc = " Index of the next slot the plugin fills."]
+    pub head: u64,
+    #[doc = " Index of the next slot pgDog drains."]
+    pub tail: u64,
+}
+#[allow(clippy::unnecessary_operation, clippy::identity_op)]
+const _: () = {
+    ["Size of CopyRing"][::std::mem::size_of::<CopyRing>() - 32usize];
+    ["Alignment of CopyRing"][::std::mem::align_of::<CopyRing>() - 8usize];
+    ["Offset of field: CopyRing::capacity"][::std::mem::offset_of!(CopyRing, capacity) - 0usize];
+    ["Offset of field: CopyRing::slots"][::std::mem::offset_of!(CopyRing, slots) - 8usize];
+    ["Offset of field: CopyRing::head"][::std::mem::offset_of!(CopyRing, head) - 16usize];
+    ["Offset of field: CopyRing::tail"][::std::mem::offset_of!(CopyRing, tail) - 24usize];
+};
+#[doc = " One route per statement of a pipeline, in statement order."]
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct PipelineOutput {
+    pub num_routes: ::std::os::raw::c_int,
+    pub routes: *mut Route,
+}
+#[allow(clippy::unnecessary_operation, clippy::identity_op)]
+const _: () = {
+    ["Size of PipelineOutput"][::std::mem::size_of::<PipelineOutput>() - 16usize];
+    ["Alignment of PipelineOutput"][::std::mem::align_of::<PipelineOutput>() - 8usize];
+    ["Offset of field: PipelineOutput::num_routes"]
+        [::std::mem::offset_of!(PipelineOutput, num_routes) - 0usize];
+    ["Offset of field: PipelineOutput::routes"]
+        [::std::mem::offset_of!(PipelineOutput, routes) - 8usize];
+};
 #[repr(C)]
 #[derive(Copy, Clone)]
 pub union RoutingOutput {
     pub route: Route,
     pub error: Error,
+    pub static_error: StaticError,
     pub intercept: Intercept,
     pub copy: Copy,
     pub copy_rows: CopyOutput,
+    pub pipeline: PipelineOutput,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of RoutingOutput"][::std::mem::size_of::<RoutingOutput>() - 40usize];
+    ["Size of RoutingOutput"][::std::mem::size_of::<RoutingOutput>() - 48usize];
     ["Alignment of RoutingOutput"][::std::mem::align_of::<RoutingOutput>() - 8usize];
     ["Offset of field: RoutingOutput::route"]
         [::std::mem::offset_of!(RoutingOutput, route) - 0usize];
     ["Offset of field: RoutingOutput::error"]
         [::std::mem::offset_of!(RoutingOutput, error) - 0usize];
+    ["Offset of field: RoutingOutput::static_error"]
+        [::std::mem::offset_of!(RoutingOutput, static_error) - 0usize];
     ["Offset of field: RoutingOutput::intercept"]
         [::std::mem::offset_of!(RoutingOutput, intercept) - 0usize];
     ["Offset of field: RoutingOutput::copy"][::std::mem::offset_of!(RoutingOutput, copy) - 0usize];
+    ["Offset of field: RoutingOutput::pipeline"]
+        [::std::mem::offset_of!(RoutingOutput, pipeline) - 0usize];
     ["Offset of field: RoutingOutput::copy_rows"]
         [::std::mem::offset_of!(RoutingOutput, copy_rows) - 0usize];
 };
@@ -271,13 +411,18 @@ const _: () = {
 pub struct Output {
     pub decision: RoutingDecision,
     pub output: RoutingOutput,
+    pub cache_ttl_ms: ::std::os::raw::c_int,
+    pub arena: *mut ::std::os::raw::c_void,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of Output"][::std::mem::size_of::<Output>() - 48usize];
+    ["Size of Output"][::std::mem::size_of::<Output>() - 72usize];
     ["Alignment of Output"][::std::mem::align_of::<Output>() - 8usize];
     ["Offset of field: Output::decision"][::std::mem::offset_of!(Output, decision) - 0usize];
     ["Offset of field: Output::output"][::std::mem::offset_of!(Output, output) - 8usize];
+    ["Offset of field: Output::cache_ttl_ms"]
+        [::std::mem::offset_of!(Output, cache_ttl_ms) - 56usize];
+    ["Offset of field: Output::arena"][::std::mem::offset_of!(Output, arena) - 64usize];
 };
 pub const Role_PRIMARY: Role = 1;
 pub const Role_REPLICA: Role = 2;
@@ -324,7 +469,29 @@ const _: () = {
     ["Offset of field: Config::name"][::std::mem::offset_of!(Config, name) - 16usize];
     ["Offset of field: Config::shards"][::std::mem::offset_of!(Config, shards) - 24usize];
 };
-#[doc = " Copy input."]
+#[doc = " Byte spans of one row inside the CopyInput buffer, precomputed\n by pgDog's vectorized pre-scan. Offsets are relative to data.\n The row span excludes the trailing newline; the key span covers\n the sharding column field, with surrounding quotes stripped."]
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct CopyRowSpan {
+    pub row_start: ::std::os::raw::c_int,
+    pub row_len: ::std::os::raw::c_int,
+    pub key_start: ::std::os::raw::c_int,
+    pub key_len: ::std::os::raw::c_int,
+}
+#[allow(clippy::unnecessary_operation, clippy::identity_op)]
+const _: () = {
+    ["Size of CopyRowSpan"][::std::mem::size_of::<CopyRowSpan>() - 16usize];
+    ["Alignment of CopyRowSpan"][::std::mem::align_of::<CopyRowSpan>() - 4usize];
+    ["Offset of field: CopyRowSpan::row_start"]
+        [::std::mem::offset_of!(CopyRowSpan, row_start) - 0usize];
+    ["Offset of field: CopyRowSpan::row_len"]
+        [::std::mem::offset_of!(CopyRowSpan, row_len) - 4usize];
+    ["Offset of field: CopyRowSpan::key_start"]
+        [::std::mem::offset_of!(CopyRowSpan, key_start) - 8usize];
+    ["Offset of field: CopyRowSpan::key_len"]
+        [::std::mem::offset_of!(CopyRowSpan, key_len) - 12usize];
+};
+#[doc = " Copy input.\n\n The data buffer outlives the plugin call: pgDog keeps it alive\n until every row produced from it — batch CopyOutput or streaming\n ring slots — has been written to its shard. Plugins should return\n borrowed CopyRows pointing into it (and advertise\n PGDOG_CAP_COPY_BORROWED) instead of copying row bytes out."]
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
 pub struct CopyInput {
@@ -333,10 +500,17 @@ pub struct CopyInput {
     pub delimiter: ::std::os::raw::c_char,
     pub has_headers: ::std::os::raw::c_int,
     pub sharding_column: ::std::os::raw::c_int,
+    #[doc = " Ring of reusable CopyRow slots for streaming mode. NULL in\n batch mode: the plugin then returns freshly allocated rows in\n a CopyOutput like before. In streaming mode the plugin fills\n slots in place, with row data pointing into the input buffer\n (zero-copy); pgDog keeps the buffer alive until every slot\n has been drained. Rows that don't fit because the ring is\n full are returned in the CopyOutput as a fallback."]
+    pub ring: *mut CopyRing,
+    #[doc = " Row boundaries and sharding key spans, found by pgDog in one\n vectorized scan of the buffer. When set (num_rows > 0), the\n plugin can hash the key bytes directly instead of running its\n own byte-at-a-time CSV scanner. Includes the header row when\n has_headers is set. Owned by pgDog, valid for the call."]
+    pub num_rows: ::std::os::raw::c_int,
+    pub rows: *const CopyRowSpan,
+    #[doc = " Data format. CSV unless the COPY statement asked for BINARY,\n in which case data holds length-prefixed binary tuples and\n delimiter/has_headers are meaningless."]
+    pub format: CopyFormat,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of CopyInput"][::std::mem::size_of::<CopyInput>() - 32usize];
+    ["Size of CopyInput"][::std::mem::size_of::<CopyInput>() - 64usize];
     ["Alignment of CopyInput"][::std::mem::align_of::<CopyInput>() - 8usize];
     ["Offset of field: CopyInput::len"][::std::mem::offset_of!(CopyInput, len) - 0usize];
     ["Offset of field: CopyInput::data"][::std::mem::offset_of!(CopyInput, data) - 8usize];
@@ -346,6 +520,11 @@ const _: () = {
         [::std::mem::offset_of!(CopyInput, has_headers) - 20usize];
     ["Offset of field: CopyInput::sharding_column"]
         [::std::mem::offset_of!(CopyInput, sharding_column) - 24usize];
+    ["Offset of field: CopyInput::ring"][::std::mem::offset_of!(CopyInput, ring) - 32usize];
+    ["Offset of field: CopyInput::num_rows"]
+        [::std::mem::offset_of!(CopyInput, num_rows) - 40usize];
+    ["Offset of field: CopyInput::rows"][::std::mem::offset_of!(CopyInput, rows) - 48usize];
+    ["Offset of field: CopyInput::format"][::std::mem::offset_of!(CopyInput, format) - 56usize];
 };
 #[doc = " Routing input union passed to the plugin."]
 #[repr(C)]
@@ -353,31 +532,73 @@ const _: () = {
 pub union RoutingInput {
     pub query: Query,
     pub copy: CopyInput,
+    pub pipeline: Pipeline,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of RoutingInput"][::std::mem::size_of::<RoutingInput>() - 32usize];
+    ["Size of RoutingInput"][::std::mem::size_of::<RoutingInput>() - 72usize];
     ["Alignment of RoutingInput"][::std::mem::align_of::<RoutingInput>() - 8usize];
     ["Offset of field: RoutingInput::query"][::std::mem::offset_of!(RoutingInput, query) - 0usize];
     ["Offset of field: RoutingInput::copy"][::std::mem::offset_of!(RoutingInput, copy) - 0usize];
+    ["Offset of field: RoutingInput::pipeline"]
+        [::std::mem::offset_of!(RoutingInput, pipeline) - 0usize];
 };
 pub const InputType_ROUTING_INPUT: InputType = 1;
 pub const InputType_COPY_INPUT: InputType = 2;
+pub const InputType_PIPELINE_INPUT: InputType = 3;
 #[doc = " Input type."]
 pub type InputType = ::std::os::raw::c_uint;
-#[doc = " Plugin input."]
+#[doc = " Completion callback for PENDING decisions.\n\n A plugin that has to wait on external I/O (e.g. a remote shard\n directory) returns PENDING from pgdog_route_query and calls this\n callback, exactly once, when its lookup finishes. Only the\n waiting client is parked; the calling thread returns to routing\n other connections immediately. The callback is safe to call from\n any thread. context is the value from the Input the decision was\n made for.\n\n The Input and everything it references are only valid for the\n duration of the pgdog_route_query call — PENDING included: pgDog\n may free them as soon as the call returns. A plugin that routes\n asynchronously must copy whatever its lookup needs before\n returning; only context may be carried into the callback."]
+pub type RouteComplete = ::std::option::Option<
+    unsafe extern "C" fn(context: *mut ::std::os::raw::c_void, output: Output),
+>;
+#[doc = " Entry points into the host's registries.\n\n The pgdog_plugin library is linked into every binary separately —\n pgDog itself, Rust plugins that embed the crate, C plugins that\n link the shared library — so each binary carries its own copy of\n the registries. pgDog installs these pointers into every plugin\n at load time through pgdog_install_host_api; the plugin-side\n helpers then forward registrations to the host's copy, which is\n the one pgDog reads."]
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct HostApi {
+    #[doc = " The host's pgdog_stats_counter: slots it returns are the\n ones aggregated into pgDog's stats surface."]
+    pub stats_counter: ::std::option::Option<
+        unsafe extern "C" fn(name: *const ::std::os::raw::c_char) -> *mut u64,
+    >,
+    #[doc = " The host's pgdog_error_register: ids it returns resolve in\n the host's registry, the one pgDog looks ERROR_STATIC\n outputs up in."]
+    pub error_register: ::std::option::Option<
+        unsafe extern "C" fn(
+            severity: *const ::std::os::raw::c_char,
+            code: *const ::std::os::raw::c_char,
+            message: *const ::std::os::raw::c_char,
+            detail: *const ::std::os::raw::c_char,
+        ) -> ::std::os::raw::c_int,
+    >,
+}
+#[allow(clippy::unnecessary_operation, clippy::identity_op)]
+const _: () = {
+    ["Size of HostApi"][::std::mem::size_of::<HostApi>() - 16usize];
+    ["Alignment of HostApi"][::std::mem::align_of::<HostApi>() - 8usize];
+    ["Offset of field: HostApi::stats_counter"]
+        [::std::mem::offset_of!(HostApi, stats_counter) - 0usize];
+    ["Offset of field: HostApi::error_register"]
+        [::std::mem::offset_of!(HostApi, error_register) - 8usize];
+};
+#[doc = " Plugin input.\n\n The cluster configuration is no longer marshalled on every call:\n plugins receive immutable Config snapshots through\n pgdog_config_update and the input only carries the generation\n number of the snapshot that was current when the query arrived."]
 #[repr(C)]
 #[derive(Copy, Clone)]
 pub struct Input {
-    pub config: Config,
+    #[doc = " Generation number of the current config snapshot."]
+    pub config_generation: u64,
     pub input_type: InputType,
     pub input: RoutingInput,
+    #[doc = " Completion callback for PENDING decisions and the value to\n call it with. NULL when pgDog can't handle an asynchronous\n decision for this input; the plugin must then decide\n synchronously."]
+    pub complete: RouteComplete,
+    pub context: *mut ::std::os::raw::c_void,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of Input"][::std::mem::size_of::<Input>() - 72usize];
+    ["Size of Input"][::std::mem::size_of::<Input>() - 104usize];
     ["Alignment of Input"][::std::mem::align_of::<Input>() - 8usize];
-    ["Offset of field: Input::config"][::std::mem::offset_of!(Input, config) - 0usize];
-    ["Offset of field: Input::input_type"][::std::mem::offset_of!(Input, input_type) - 32usize];
-    ["Offset of field: Input::input"][::std::mem::offset_of!(Input, input) - 40usize];
+    ["Offset of field: Input::config_generation"]
+        [::std::mem::offset_of!(Input, config_generation) - 0usize];
+    ["Offset of field: Input::input_type"][::std::mem::offset_of!(Input, input_type) - 8usize];
+    ["Offset of field: Input::input"][::std::mem::offset_of!(Input, input) - 16usize];
+    ["Offset of field: Input::complete"][::std::mem::offset_of!(Input, complete) - 88usize];
+    ["Offset of field: Input::context"][::std::mem::offset_of!(Input, context) - 96usize];
 };
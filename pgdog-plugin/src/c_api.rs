@@ -1,6 +1,8 @@
 use crate::bindings::*;
 use std::alloc::{alloc, dealloc, Layout};
-use std::ffi::c_int;
+use std::ffi::{c_char, c_int, c_ulong, c_void};
+use std::ptr::null_mut;
+use std::sync::Mutex;
 
 /// Create new row.
 #[no_mangle]
@@ -22,3 +24,626 @@ pub extern "C" fn pgdog_row_free(row: Row) {
         dealloc(row.columns as *mut u8, layout);
     }
 }
+
+/// Decode a parameter as a 64-bit integer.
+///
+/// Returns 1 and writes the value on success, 0 if the parameter
+/// isn't an integer.
+///
+/// # Safety
+///
+/// `param` and `value` must be null or valid pointers.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_param_as_int8(param: *const Parameter, value: *mut i64) -> c_int {
+    match param.as_ref().and_then(|param| param.as_int8()) {
+        Some(decoded) if !value.is_null() => {
+            *value = decoded;
+            1
+        }
+        _ => 0,
+    }
+}
+
+/// Decode a parameter as a 32-bit integer.
+///
+/// Returns 1 and writes the value on success, 0 if the parameter
+/// isn't an integer.
+///
+/// # Safety
+///
+/// `param` and `value` must be null or valid pointers.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_param_as_int4(param: *const Parameter, value: *mut i32) -> c_int {
+    match param.as_ref().and_then(|param| param.as_int4()) {
+        Some(decoded) if !value.is_null() => {
+            *value = decoded;
+            1
+        }
+        _ => 0,
+    }
+}
+
+/// Decode a parameter as a UUID.
+///
+/// Returns 1 and writes 16 bytes in network order on success,
+/// 0 if the parameter isn't a UUID.
+///
+/// # Safety
+///
+/// `param` must be null or valid; `bytes` must be null or point to
+/// at least 16 writable bytes.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_param_as_uuid(param: *const Parameter, bytes: *mut u8) -> c_int {
+    match param.as_ref().and_then(|param| param.as_uuid()) {
+        Some(decoded) if !bytes.is_null() => {
+            std::ptr::copy_nonoverlapping(decoded.as_ptr(), bytes, decoded.len());
+            1
+        }
+        _ => 0,
+    }
+}
+
+/// Push a row into the COPY ring.
+///
+/// Returns 1 on success, 0 if the ring is full or null.
+///
+/// # Safety
+///
+/// `ring` must be null or point to a valid CopyRing.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_copy_ring_push(ring: *mut CopyRing, row: CopyRow) -> c_int {
+    match ring.as_ref() {
+        Some(ring) => ring.push(row) as c_int,
+        None => 0,
+    }
+}
+
+/// Classify the leading SQL keyword of a query.
+///
+/// Zero-allocation replacement for the strdup/tolower/strncmp
+/// pattern plugins copy from the examples. Pass -1 for `len` if the
+/// query is NUL-terminated.
+///
+/// # Safety
+///
+/// `query` must be null or point to `len` valid bytes (or a
+/// NUL-terminated string if `len` is negative).
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_query_verb(query: *const c_char, len: c_int) -> StatementKind {
+    if query.is_null() {
+        return StatementKind_STATEMENT_UNKNOWN;
+    }
+
+    let len = if len < 0 {
+        std::ffi::CStr::from_ptr(query).count_bytes()
+    } else {
+        len as usize
+    };
+
+    query_verb(std::slice::from_raw_parts(query as *const u8, len))
+}
+
+/// Register an error the plugin intends to return.
+///
+/// Call at `pgdog_init()` time; the id goes into a StaticError
+/// output and the rejection path allocates nothing. Returns -1 if
+/// a required argument is null.
+///
+/// # Safety
+///
+/// `severity`, `code` and `message` must be valid NUL-terminated
+/// strings; `detail` may be null.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_error_register(
+    severity: *const c_char,
+    code: *const c_char,
+    message: *const c_char,
+    detail: *const c_char,
+) -> c_int {
+    if severity.is_null() || code.is_null() || message.is_null() {
+        return -1;
+    }
+
+    let severity = std::ffi::CStr::from_ptr(severity).to_string_lossy();
+    let code = std::ffi::CStr::from_ptr(code).to_string_lossy();
+    let message = std::ffi::CStr::from_ptr(message).to_string_lossy();
+    let detail = if detail.is_null() {
+        None
+    } else {
+        Some(std::ffi::CStr::from_ptr(detail).to_string_lossy())
+    };
+
+    crate::error::error_register(&severity, &code, &message, detail.as_deref()).unwrap_or(-1)
+}
+
+/// Pre-encode an intercepted result into wire bytes.
+///
+/// Returns a buffer holding the RowDescription and DataRow messages
+/// the client will receive, allocated with the global allocator.
+/// Set it on the Intercept together with its length; pgDog frees it
+/// after the result has been sent. Returns null if any argument is
+/// null.
+///
+/// # Safety
+///
+/// `row_description` must point to a valid RowDescription, `rows`
+/// to `num_rows` valid Row entries, and `len` to writable memory.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_row_preencode(
+    row_description: *const RowDescription,
+    rows: *const Row,
+    num_rows: c_int,
+    len: *mut c_ulong,
+) -> *mut c_char {
+    if row_description.is_null() || rows.is_null() || len.is_null() {
+        return null_mut();
+    }
+
+    let encoded = row_preencode(
+        &*row_description,
+        std::slice::from_raw_parts(rows, num_rows as usize),
+    );
+
+    let layout = Layout::array::<u8>(encoded.len()).unwrap();
+    let buffer = alloc(layout);
+    std::ptr::copy(encoded.as_ptr(), buffer, encoded.len());
+    *len = encoded.len() as c_ulong;
+
+    buffer as *mut c_char
+}
+
+/// Encode an intercepted result into RowDescription ('T') and
+/// DataRow ('D') wire messages, ready to send to the client as-is.
+///
+/// Columns are described as text format with unknown size and
+/// modifier, which is what every driver expects from a proxy.
+/// A row column with a negative length encodes as SQL NULL.
+pub fn row_preencode(row_description: &RowDescription, rows: &[Row]) -> Vec<u8> {
+    let mut encoded = Vec::new();
+
+    // RowDescription.
+    encoded.push(b'T');
+    let len_at = encoded.len();
+    encoded.extend_from_slice(&[0u8; 4]);
+    encoded.extend_from_slice(&(row_description.num_columns as i16).to_be_bytes());
+    for column in unsafe {
+        std::slice::from_raw_parts(
+            row_description.columns,
+            row_description.num_columns as usize,
+        )
+    } {
+        let name =
+            unsafe { std::slice::from_raw_parts(column.name as *const u8, column.len as usize) };
+        encoded.extend_from_slice(name);
+        encoded.push(0); // NUL terminator.
+        encoded.extend_from_slice(&0i32.to_be_bytes()); // Table OID.
+        encoded.extend_from_slice(&0i16.to_be_bytes()); // Column number.
+        encoded.extend_from_slice(&column.oid.to_be_bytes());
+        encoded.extend_from_slice(&(-1i16).to_be_bytes()); // Type size.
+        encoded.extend_from_slice(&(-1i32).to_be_bytes()); // Type modifier.
+        encoded.extend_from_slice(&0i16.to_be_bytes()); // Text format.
+    }
+    let message_len = (encoded.len() - len_at) as i32;
+    encoded[len_at..len_at + 4].copy_from_slice(&message_len.to_be_bytes());
+
+    // DataRows.
+    for row in rows {
+        encoded.push(b'D');
+        let len_at = encoded.len();
+        encoded.extend_from_slice(&[0u8; 4]);
+        encoded.extend_from_slice(&(row.num_columns as i16).to_be_bytes());
+        for column in
+            unsafe { std::slice::from_raw_parts(row.columns, row.num_columns as usize) }
+        {
+            if column.length < 0 {
+                encoded.extend_from_slice(&(-1i32).to_be_bytes()); // NULL.
+            } else {
+                encoded.extend_from_slice(&column.length.to_be_bytes());
+                let data = unsafe {
+                    std::slice::from_raw_parts(column.data as *const u8, column.length as usize)
+                };
+                encoded.extend_from_slice(data);
+            }
+        }
+        let message_len = (encoded.len() - len_at) as i32;
+        encoded[len_at..len_at + 4].copy_from_slice(&message_len.to_be_bytes());
+    }
+
+    encoded
+}
+
+/// Memory-map a shard directory file.
+///
+/// Returns an opaque handle, or null if the file can't be opened
+/// or isn't a shard map. Open once in `pgdog_init()`; the handle
+/// is safe to share across threads.
+///
+/// # Safety
+///
+/// `path` must be null or a valid NUL-terminated string.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_shardmap_open(path: *const c_char) -> *mut c_void {
+    if path.is_null() {
+        return null_mut();
+    }
+
+    let path = std::ffi::OsStr::from_encoded_bytes_unchecked(
+        std::ffi::CStr::from_ptr(path).to_bytes(),
+    );
+
+    match crate::shardmap::ShardMap::open(path) {
+        Ok(map) => Box::into_raw(Box::new(map)) as *mut c_void,
+        Err(_) => null_mut(),
+    }
+}
+
+/// Look up the shard for a key in a shard directory.
+///
+/// Returns the shard, or -1 if the key isn't in the directory.
+///
+/// # Safety
+///
+/// `map` must be null or a handle from `pgdog_shardmap_open`.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_shardmap_lookup(map: *const c_void, key: i64) -> c_int {
+    match (map as *const crate::shardmap::ShardMap).as_ref() {
+        Some(map) => map.lookup(key).unwrap_or(-1),
+        None => -1,
+    }
+}
+
+/// Unmap a shard directory.
+///
+/// # Safety
+///
+/// `map` must be null or a handle from `pgdog_shardmap_open`, and
+/// must not be used afterwards.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_shardmap_close(map: *mut c_void) {
+    if !map.is_null() {
+        drop(Box::from_raw(map as *mut crate::shardmap::ShardMap));
+    }
+}
+
+/// Get a statistics counter slot by name, registering it on first
+/// use.
+///
+/// The slot is a cacheline-padded atomic u64, valid for the life of
+/// the process; increment it with a relaxed atomic add. pgDog
+/// aggregates all slots into its stats surface. Returns null if
+/// `name` is null.
+///
+/// # Safety
+///
+/// `name` must be null or a valid NUL-terminated string.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_stats_counter(name: *const c_char) -> *mut u64 {
+    if name.is_null() {
+        return null_mut();
+    }
+
+    let name = std::ffi::CStr::from_ptr(name).to_string_lossy();
+    crate::counter::counter(&name).as_ptr()
+}
+
+/// The host's registry entry points, installed by pgDog at load
+/// time. Never set in pgDog itself: the host's own registries are
+/// the authoritative ones.
+static HOST_API: Mutex<Option<HostApi>> = Mutex::new(None);
+
+/// The installed host entry points, if pgDog handed us any.
+pub(crate) fn host_api() -> Option<HostApi> {
+    *HOST_API.lock().unwrap()
+}
+
+/// Install the host's registry entry points.
+///
+/// Every binary linking this crate carries its own copy of the
+/// registries, so registrations a plugin makes would otherwise land
+/// in a copy the host never reads. pgDog calls this through the
+/// plugin's export before `pgdog_init()`; the registry helpers then
+/// forward to the host.
+#[no_mangle]
+pub extern "C" fn pgdog_install_host_api(api: HostApi) {
+    *HOST_API.lock().unwrap() = Some(api);
+}
+
+/// All lowercase ASCII letters have bit 0x20 set; OR-ing it in
+/// lowercases both cases in one operation.
+const LOWERCASE: u64 = 0x2020202020202020;
+
+/// Classify the leading SQL keyword of a query.
+///
+/// One pass and no allocation: whitespace and comments are skipped,
+/// then the keyword is matched SWAR-style — up to eight bytes loaded
+/// into one register, ASCII-lowercased with a single OR and compared
+/// against the packed keyword under a length mask, instead of
+/// byte-at-a-time strncmp.
+pub fn query_verb(query: &[u8]) -> StatementKind {
+    const VERBS: [(&[u8], StatementKind); 6] = [
+        (b"select", StatementKind_STATEMENT_SELECT),
+        (b"insert", StatementKind_STATEMENT_INSERT),
+        (b"update", StatementKind_STATEMENT_UPDATE),
+        (b"delete", StatementKind_STATEMENT_DELETE),
+        (b"begin", StatementKind_STATEMENT_BEGIN),
+        (b"commit", StatementKind_STATEMENT_COMMIT),
+    ];
+
+    let rest = &query[skip_whitespace_and_comments(query)..];
+
+    let mut word = [0u8; 8];
+    let take = rest.len().min(8);
+    word[..take].copy_from_slice(&rest[..take]);
+    let word = u64::from_le_bytes(word) | LOWERCASE;
+
+    for (verb, kind) in VERBS {
+        if rest.len() < verb.len() {
+            continue;
+        }
+
+        let mut packed = [0u8; 8];
+        packed[..verb.len()].copy_from_slice(verb);
+        let mask = if verb.len() == 8 {
+            u64::MAX
+        } else {
+            (1u64 << (verb.len() * 8)) - 1
+        };
+
+        if word & mask == u64::from_le_bytes(packed) {
+            // Keyword boundary: don't match SELECTED or BEGINNING.
+            match rest.get(verb.len()) {
+                Some(next) if next.is_ascii_alphanumeric() || *next == b'_' => continue,
+                _ => return kind,
+            }
+        }
+    }
+
+    StatementKind_STATEMENT_UNKNOWN
+}
+
+/// Skip leading whitespace, line comments and (nested) block
+/// comments. Returns the offset of the first code byte.
+fn skip_whitespace_and_comments(query: &[u8]) -> usize {
+    let mut pos = 0;
+
+    loop {
+        match query.get(pos) {
+            Some(b' ' | b'\t' | b'\n' | b'\r' | b'\x0b' | b'\x0c') => pos += 1,
+            Some(b'-') if query.get(pos + 1) == Some(&b'-') => {
+                while pos < query.len() && query[pos] != b'\n' {
+                    pos += 1;
+                }
+            }
+            Some(b'/') if query.get(pos + 1) == Some(&b'*') => {
+                let mut depth = 1;
+                pos += 2;
+                while pos < query.len() && depth > 0 {
+                    if query[pos..].starts_with(b"/*") {
+                        depth += 1;
+                        pos += 2;
+                    } else if query[pos..].starts_with(b"*/") {
+                        depth -= 1;
+                        pos += 2;
+                    } else {
+                        pos += 1;
+                    }
+                }
+            }
+            _ => return pos,
+        }
+    }
+}
+
+/// Allocations larger than this get a dedicated chunk.
+const ARENA_CHUNK_SIZE: usize = 16 * 1024;
+/// Arena allocations are aligned like malloc(3).
+const ARENA_ALIGN: usize = 16;
+
+struct ArenaChunk {
+    ptr: *mut u8,
+    layout: Layout,
+    /// Offset of the next free byte.
+    offset: usize,
+}
+
+impl ArenaChunk {
+    fn new(size: usize) -> Self {
+        let layout = Layout::from_size_align(size, ARENA_ALIGN).unwrap();
+        let ptr = unsafe { alloc(layout) };
+
+        Self {
+            ptr,
+            layout,
+            offset: 0,
+        }
+    }
+}
+
+/// Bump allocator backing the plugin output arena.
+///
+/// Intercept results allocate a RowDescription, a Row array and
+/// a buffer per column. Drawing them all from one arena replaces
+/// many small malloc/free pairs with a single free after the
+/// result has been sent.
+struct Arena {
+    chunks: Vec<ArenaChunk>,
+}
+
+impl Arena {
+    fn new() -> Self {
+        Self {
+            chunks: vec![ArenaChunk::new(ARENA_CHUNK_SIZE)],
+        }
+    }
+
+    fn alloc(&mut self, size: usize) -> *mut u8 {
+        // Keep subsequent allocations aligned.
+        let size = size.div_ceil(ARENA_ALIGN) * ARENA_ALIGN;
+
+        if size > ARENA_CHUNK_SIZE {
+            // Dedicated chunk, placed behind the current one
+            // so smaller allocations keep filling it up.
+            let chunk = ArenaChunk::new(size);
+            let ptr = chunk.ptr;
+            let position = self.chunks.len() - 1;
+            self.chunks.insert(position, chunk);
+            return ptr;
+        }
+
+        let chunk = self.chunks.last_mut().unwrap();
+        if chunk.offset + size > chunk.layout.size() {
+            self.chunks.push(ArenaChunk::new(ARENA_CHUNK_SIZE));
+        }
+
+        let chunk = self.chunks.last_mut().unwrap();
+        let ptr = unsafe { chunk.ptr.add(chunk.offset) };
+        chunk.offset += size;
+
+        ptr
+    }
+
+    fn reset(&mut self) {
+        while self.chunks.len() > 1 {
+            let chunk = self.chunks.remove(0);
+            unsafe { dealloc(chunk.ptr, chunk.layout) };
+        }
+        self.chunks.last_mut().unwrap().offset = 0;
+    }
+}
+
+impl Drop for Arena {
+    fn drop(&mut self) {
+        for chunk in &self.chunks {
+            unsafe { dealloc(chunk.ptr, chunk.layout) };
+        }
+    }
+}
+
+/// Create new allocation arena.
+#[no_mangle]
+pub extern "C" fn pgdog_arena_new() -> *mut c_void {
+    Box::into_raw(Box::new(Arena::new())) as *mut c_void
+}
+
+/// Allocate memory from the arena. The pointer remains valid
+/// until the arena is reset or freed.
+#[no_mangle]
+pub extern "C" fn pgdog_arena_alloc(arena: *mut c_void, size: c_ulong) -> *mut c_void {
+    if arena.is_null() {
+        return null_mut();
+    }
+    let arena = unsafe { &mut *(arena as *mut Arena) };
+
+    arena.alloc(size as usize) as *mut c_void
+}
+
+/// Free all allocations made from the arena, keeping the arena
+/// itself around for reuse.
+#[no_mangle]
+pub extern "C" fn pgdog_arena_reset(arena: *mut c_void) {
+    if arena.is_null() {
+        return;
+    }
+    let arena = unsafe { &mut *(arena as *mut Arena) };
+
+    arena.reset();
+}
+
+/// Free the arena and everything allocated from it.
+#[no_mangle]
+pub extern "C" fn pgdog_arena_free(arena: *mut c_void) {
+    if arena.is_null() {
+        return;
+    }
+    unsafe { drop(Box::from_raw(arena as *mut Arena)) };
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_query_verb() {
+        assert_eq!(query_verb(b"SELECT 1"), StatementKind_STATEMENT_SELECT);
+        assert_eq!(query_verb(b"select"), StatementKind_STATEMENT_SELECT);
+        assert_eq!(
+            query_verb(b"  -- routed\n\tInSeRt INTO users"),
+            StatementKind_STATEMENT_INSERT
+        );
+        assert_eq!(
+            query_verb(b"/* outer /* nested */ */ UPDATE users SET x = 1"),
+            StatementKind_STATEMENT_UPDATE
+        );
+        assert_eq!(
+            query_verb(b"delete from users"),
+            StatementKind_STATEMENT_DELETE
+        );
+        assert_eq!(query_verb(b"BEGIN;"), StatementKind_STATEMENT_BEGIN);
+        assert_eq!(query_verb(b"commit"), StatementKind_STATEMENT_COMMIT);
+
+        // Keyword boundaries and noise.
+        assert_eq!(query_verb(b"SELECTED"), StatementKind_STATEMENT_UNKNOWN);
+        assert_eq!(query_verb(b"beginning"), StatementKind_STATEMENT_UNKNOWN);
+        assert_eq!(query_verb(b""), StatementKind_STATEMENT_UNKNOWN);
+        assert_eq!(query_verb(b"/* open"), StatementKind_STATEMENT_UNKNOWN);
+    }
+
+    #[test]
+    fn test_row_preencode() {
+        let name = b"version";
+        let mut column = RowDescriptionColumn {
+            len: name.len() as i32,
+            name: name.as_ptr() as *mut _,
+            oid: 25, // TEXT
+        };
+        let row_description = RowDescription {
+            num_columns: 1,
+            columns: &mut column,
+        };
+
+        let value = b"PostgreSQL 17.0";
+        let mut row_column = RowColumn {
+            length: value.len() as i32,
+            data: value.as_ptr() as *mut _,
+        };
+        let row = Row {
+            num_columns: 1,
+            columns: &mut row_column,
+        };
+
+        let encoded = row_preencode(&row_description, &[row]);
+
+        // RowDescription: tag, length, one text-format column.
+        assert_eq!(encoded[0], b'T');
+        let len = i32::from_be_bytes(encoded[1..5].try_into().unwrap()) as usize;
+        assert_eq!(i16::from_be_bytes(encoded[5..7].try_into().unwrap()), 1);
+        assert_eq!(&encoded[7..14], name);
+        assert_eq!(encoded[14], 0);
+
+        // DataRow follows immediately, carrying the value verbatim.
+        let data_row = &encoded[1 + len..];
+        assert_eq!(data_row[0], b'D');
+        assert_eq!(i16::from_be_bytes(data_row[5..7].try_into().unwrap()), 1);
+        assert_eq!(
+            i32::from_be_bytes(data_row[7..11].try_into().unwrap()),
+            value.len() as i32
+        );
+        assert_eq!(&data_row[11..11 + value.len()], value);
+        assert_eq!(1 + len + data_row.len(), encoded.len());
+
+        // NULL column.
+        let mut null_column = RowColumn {
+            length: -1,
+            data: std::ptr::null_mut(),
+        };
+        let null_row = Row {
+            num_columns: 1,
+            columns: &mut null_column,
+        };
+        let encoded = row_preencode(&row_description, &[null_row]);
+        assert_eq!(
+            i32::from_be_bytes(encoded[1 + len + 7..1 + len + 11].try_into().unwrap()),
+            -1
+        );
+    }
+}
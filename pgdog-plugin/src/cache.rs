@@ -0,0 +1,279 @@
+//! Route decision cache.
+//!
+//! Plugins are consulted for every transaction. For workloads dominated
+//! by a few hundred distinct prepared statements, the routing decision
+//! for a statement rarely changes. When a plugin marks its output as
+//! cacheable, the route is memoized by statement fingerprint and repeat
+//! queries are answered with a hash table lookup instead of an FFI call
+//! into the shared library.
+//!
+//! INTERCEPT results get the same treatment one level further down:
+//! ORMs hammer proxies with identical metadata queries (SELECT
+//! version(), SHOW transaction_isolation, catalog probes) that plugins
+//! answer by building the same rows over and over. The caller encodes
+//! the intercepted result into wire bytes once, caches them here, and
+//! serves repeat queries with a memcpy.
+//!
+//! The fingerprint is a fast non-cryptographic hash, so every entry
+//! also stores its statement text and a hit is only served when the
+//! text matches: a fingerprint collision degrades to a cache miss,
+//! never to another statement's route. Each map is bounded; at
+//! capacity, expired entries are evicted and the new entry is dropped
+//! if the map is still full.
+#![allow(non_upper_case_globals)]
+
+use std::collections::HashMap;
+use std::sync::{Arc, Mutex};
+use std::time::{Duration, Instant};
+
+use crate::bindings::{Output, Route, RoutingDecision_FORWARD};
+
+/// Upper bound on entries per map. Statements with inline literals
+/// fingerprint uniquely; without a bound an ad-hoc workload grows the
+/// cache for as long as the plugin stays loaded.
+const MAX_ENTRIES: usize = 10_000;
+
+#[derive(Debug)]
+struct CachedRoute {
+    /// Statement text the fingerprint was computed from.
+    query: String,
+    route: Route,
+    /// `None` means the entry doesn't expire.
+    expires: Option<Instant>,
+}
+
+#[derive(Debug)]
+struct CachedIntercept {
+    /// Statement text the fingerprint was computed from.
+    query: String,
+    /// Pre-encoded wire messages for the intercepted result.
+    bytes: Arc<Vec<u8>>,
+    /// `None` means the entry doesn't expire.
+    expires: Option<Instant>,
+}
+
+/// Route decision cache keyed by statement fingerprint.
+#[derive(Debug, Default)]
+pub struct RouteCache {
+    routes: Mutex<HashMap<u64, CachedRoute>>,
+    intercepts: Mutex<HashMap<u64, CachedIntercept>>,
+}
+
+/// SAFETY: only routes without ORDER BY columns are stored (see
+/// [`RouteCache::store`]), so the raw pointer inside Route is never
+/// populated and all shared state sits behind the mutex.
+unsafe impl Send for RouteCache {}
+unsafe impl Sync for RouteCache {}
+
+/// Evict expired entries; called when a map hits its bound.
+fn evict_expired<T>(map: &mut HashMap<u64, T>, expires: impl Fn(&T) -> Option<Instant>) {
+    let now = Instant::now();
+    map.retain(|_, entry| match expires(entry) {
+        Some(deadline) => deadline > now,
+        None => true,
+    });
+}
+
+impl RouteCache {
+    /// Look up a cached decision for this exact statement. Expired
+    /// entries are evicted; a fingerprint collision is a miss.
+    pub fn get(&self, fingerprint: u64, query: &str) -> Option<Output> {
+        let mut guard = self.routes.lock().unwrap();
+        if let Some(entry) = guard.get(&fingerprint) {
+            if let Some(expires) = entry.expires {
+                if expires <= Instant::now() {
+                    guard.remove(&fingerprint);
+                    return None;
+                }
+            }
+            if entry.query != query {
+                return None;
+            }
+            return Some(Output::new_forward(entry.route));
+        }
+
+        None
+    }
+
+    /// Store a decision if the plugin marked it as cacheable.
+    ///
+    /// Only plain FORWARD decisions are memoized: outputs carrying
+    /// allocations (ORDER BY columns, errors, intercepted rows) are
+    /// owned by the caller and deallocated after use, so caching them
+    /// would leave dangling pointers.
+    pub fn store(&self, fingerprint: u64, query: &str, output: &Output) {
+        if output.cache_ttl_ms == 0 || output.decision != RoutingDecision_FORWARD {
+            return;
+        }
+
+        let route = match output.route() {
+            Some(route) if route.num_order_by == 0 => route,
+            _ => return,
+        };
+
+        let expires = if output.cache_ttl_ms > 0 {
+            Some(Instant::now() + Duration::from_millis(output.cache_ttl_ms as u64))
+        } else {
+            None
+        };
+
+        let mut guard = self.routes.lock().unwrap();
+        if guard.len() >= MAX_ENTRIES && !guard.contains_key(&fingerprint) {
+            evict_expired(&mut guard, |entry| entry.expires);
+            if guard.len() >= MAX_ENTRIES {
+                return;
+            }
+        }
+        guard.insert(
+            fingerprint,
+            CachedRoute {
+                query: query.to_string(),
+                route,
+                expires,
+            },
+        );
+    }
+
+    /// Look up pre-encoded wire bytes for this exact intercepted
+    /// statement. Expired entries are evicted; a fingerprint
+    /// collision is a miss.
+    pub fn intercept(&self, fingerprint: u64, query: &str) -> Option<Arc<Vec<u8>>> {
+        let mut guard = self.intercepts.lock().unwrap();
+        if let Some(entry) = guard.get(&fingerprint) {
+            if let Some(expires) = entry.expires {
+                if expires <= Instant::now() {
+                    guard.remove(&fingerprint);
+                    return None;
+                }
+            }
+            if entry.query != query {
+                return None;
+            }
+            return Some(entry.bytes.clone());
+        }
+
+        None
+    }
+
+    /// Store the encoded wire bytes of an intercepted result.
+    ///
+    /// The caller encodes the Intercept structure once and hands the
+    /// bytes over; the plugin's allocations are freed as usual.
+    pub fn store_intercept(&self, fingerprint: u64, query: &str, bytes: &[u8], ttl_ms: i32) {
+        if ttl_ms == 0 {
+            return;
+        }
+
+        let expires = if ttl_ms > 0 {
+            Some(Instant::now() + Duration::from_millis(ttl_ms as u64))
+        } else {
+            None
+        };
+
+        let mut guard = self.intercepts.lock().unwrap();
+        if guard.len() >= MAX_ENTRIES && !guard.contains_key(&fingerprint) {
+            evict_expired(&mut guard, |entry| entry.expires);
+            if guard.len() >= MAX_ENTRIES {
+                return;
+            }
+        }
+        guard.insert(
+            fingerprint,
+            CachedIntercept {
+                query: query.to_string(),
+                bytes: Arc::new(bytes.to_vec()),
+                expires,
+            },
+        );
+    }
+
+    /// Number of memoized decisions.
+    pub fn len(&self) -> usize {
+        self.routes.lock().unwrap().len() + self.intercepts.lock().unwrap().len()
+    }
+
+    /// Is the cache empty?
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Forget all memoized decisions.
+    pub fn reset(&self) {
+        let mut guard = self.routes.lock().unwrap();
+        guard.clear();
+        guard.shrink_to_fit();
+        drop(guard);
+
+        let mut guard = self.intercepts.lock().unwrap();
+        guard.clear();
+        guard.shrink_to_fit();
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_route_cache() {
+        let cache = RouteCache::default();
+        let query = "SELECT * FROM users WHERE id = $1";
+
+        // Not cacheable by default.
+        cache.store(1, query, &Output::new_forward(Route::read(0)));
+        assert!(cache.get(1, query).is_none());
+
+        cache.store(1, query, &Output::new_forward(Route::read(0)).cache(-1));
+        let output = cache.get(1, query).expect("cached route");
+        assert_eq!(output.route().unwrap().shard(), Some(0));
+
+        // A fingerprint collision is a miss, not another
+        // statement's route.
+        assert!(cache.get(1, "SELECT 1").is_none());
+
+        // Expired entries are evicted.
+        cache.store(2, query, &Output::new_forward(Route::write(1)).cache(1));
+        std::thread::sleep(Duration::from_millis(5));
+        assert!(cache.get(2, query).is_none());
+        assert_eq!(cache.len(), 1);
+    }
+
+    #[test]
+    fn test_intercept_cache() {
+        let cache = RouteCache::default();
+        let query = "SELECT version()";
+        let bytes = b"T...D...C...Z...";
+
+        cache.store_intercept(1, query, bytes, 0);
+        assert!(cache.intercept(1, query).is_none());
+
+        cache.store_intercept(1, query, bytes, -1);
+        assert_eq!(
+            *cache.intercept(1, query).expect("cached bytes"),
+            bytes.to_vec()
+        );
+        assert!(cache.intercept(1, "SHOW timezone").is_none());
+
+        cache.store_intercept(2, query, bytes, 1);
+        std::thread::sleep(Duration::from_millis(5));
+        assert!(cache.intercept(2, query).is_none());
+
+        cache.reset();
+        assert!(cache.intercept(1, query).is_none());
+    }
+
+    #[test]
+    fn test_cache_bound() {
+        let cache = RouteCache::default();
+
+        for fingerprint in 0..(MAX_ENTRIES as u64 + 100) {
+            cache.store(
+                fingerprint,
+                "SELECT 1",
+                &Output::new_forward(Route::read(0)).cache(-1),
+            );
+        }
+
+        assert_eq!(cache.len(), MAX_ENTRIES);
+    }
+}
@@ -47,7 +47,7 @@ impl DatabaseConfig {
     ///
     /// This is not to be used by plugins.
     /// This is for internal pgDog usage only.
-    pub(crate) unsafe fn deallocate(&self) {
+    pub unsafe fn deallocate(&self) {
         drop(unsafe { CString::from_raw(self.host) })
     }
 }
@@ -97,7 +97,7 @@ impl Config {
     /// # Safety
     ///
     /// This is for internal pgDog usage only.
-    pub(crate) unsafe fn deallocate(&self) {
+    pub unsafe fn deallocate(&self) {
         self.databases().into_iter().for_each(|d| d.deallocate());
 
         let layout = Layout::array::<DatabaseConfig>(self.num_databases as usize).unwrap();
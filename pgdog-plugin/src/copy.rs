@@ -3,15 +3,16 @@
 use libc::c_char;
 
 use crate::{
-    bindings::{Copy, CopyInput, CopyOutput, CopyRow},
-    CopyFormat_CSV, CopyFormat_INVALID,
+    bindings::{Copy, CopyInput, CopyOutput, CopyRing, CopyRow, CopyRowSpan},
+    CopyFormat, CopyFormat_BINARY, CopyFormat_CSV, CopyFormat_INVALID,
 };
 use std::{
-    alloc::{alloc, dealloc, Layout},
+    alloc::{alloc, alloc_zeroed, dealloc, Layout},
     ffi::{CStr, CString},
-    ptr::{copy, null_mut},
+    ptr::{copy, null, null_mut},
     slice::from_raw_parts,
     str::from_utf8_unchecked,
+    sync::atomic::{AtomicU64, Ordering},
 };
 
 impl Copy {
@@ -53,6 +54,15 @@ impl Copy {
         }
     }
 
+    /// Create new binary copy command. No delimiter or headers:
+    /// the data stream is length-prefixed binary tuples.
+    pub fn binary(table_name: &str, columns: &[&str]) -> Self {
+        Self {
+            copy_format: CopyFormat_BINARY,
+            ..Self::new(table_name, false, ',', columns)
+        }
+    }
+
     /// Get table name.
     pub fn table_name(&self) -> &str {
         unsafe { CStr::from_ptr(self.table_name).to_str().unwrap() }
@@ -111,9 +121,54 @@ impl CopyInput {
             sharding_column: sharding_column as i32,
             has_headers: if headers { 1 } else { 0 },
             delimiter: delimiter as c_char,
+            ring: null_mut(),
+            num_rows: 0,
+            rows: null(),
+            format: CopyFormat_CSV,
+        }
+    }
+
+    /// Set the data format. CSV by default.
+    pub fn with_format(mut self, format: CopyFormat) -> Self {
+        self.format = format;
+        self
+    }
+
+    /// Is this Postgres binary COPY data?
+    pub fn is_binary(&self) -> bool {
+        self.format == CopyFormat_BINARY
+    }
+
+    /// Attach row spans precomputed by the vectorized pre-scan.
+    /// The caller owns the spans and keeps them alive for the call.
+    pub fn with_row_spans(mut self, rows: &[CopyRowSpan]) -> Self {
+        self.num_rows = rows.len() as i32;
+        self.rows = rows.as_ptr();
+        self
+    }
+
+    /// Precomputed row spans, if pgDog attached them.
+    pub fn row_spans(&self) -> &[CopyRowSpan] {
+        if self.rows.is_null() {
+            &[]
+        } else {
+            unsafe { from_raw_parts(self.rows, self.num_rows as usize) }
         }
     }
 
+    /// Attach a ring of reusable CopyRow slots, enabling streaming
+    /// mode for this input. The ring outlives the input: it's reused
+    /// for every chunk of one COPY statement.
+    pub fn with_ring(mut self, ring: *mut CopyRing) -> Self {
+        self.ring = ring;
+        self
+    }
+
+    /// Get the streaming ring, if the caller attached one.
+    pub fn ring(&self) -> Option<&CopyRing> {
+        unsafe { self.ring.as_ref() }
+    }
+
     /// Get data as slice.
     pub fn data(&self) -> &[u8] {
         unsafe { from_raw_parts(self.data as *const u8, self.len as usize) }
@@ -135,6 +190,18 @@ impl CopyInput {
     }
 }
 
+impl CopyRowSpan {
+    /// Row bytes inside the copy buffer, excluding the newline.
+    pub fn row<'a>(&self, data: &'a [u8]) -> &'a [u8] {
+        &data[self.row_start as usize..(self.row_start + self.row_len) as usize]
+    }
+
+    /// Sharding key bytes inside the copy buffer, quotes stripped.
+    pub fn key<'a>(&self, data: &'a [u8]) -> &'a [u8] {
+        &data[self.key_start as usize..(self.key_start + self.key_len) as usize]
+    }
+}
+
 impl CopyRow {
     /// Create new row from data slice.
     pub fn new(data: &[u8], shard: i32) -> Self {
@@ -146,9 +213,26 @@ impl CopyRow {
             len: data.len() as i32,
             data: data_ptr,
             shard,
+            borrowed: 0,
         }
     }
 
+    /// Create a borrowed view into the CopyInput buffer. pgDog keeps
+    /// the buffer alive until the row has been written to its shard
+    /// and writes it straight out of the buffer with vectored I/O:
+    /// no bytes are copied and nothing is freed per row.
+    pub fn borrowed(data: &[u8], shard: i32) -> Self {
+        Self {
+            borrowed: 1,
+            ..Self::new(data, shard)
+        }
+    }
+
+    /// Does this row point into the CopyInput buffer?
+    pub fn is_borrowed(&self) -> bool {
+        self.borrowed != 0
+    }
+
     /// Shard this row should go to.
     pub fn shard(&self) -> usize {
         self.shard as usize
@@ -165,6 +249,7 @@ impl std::fmt::Debug for CopyRow {
         f.debug_struct("CopyRow")
             .field("len", &self.len)
             .field("shard", &self.shard)
+            .field("borrowed", &self.is_borrowed())
             .field("data", &unsafe { from_utf8_unchecked(self.data()) })
             .finish()
     }
@@ -211,6 +296,27 @@ impl CopyOutput {
         }
     }
 
+    /// Group row byte slices by destination shard, in row order:
+    /// the iovec list for each shard's vectored backend write. Rows
+    /// are borrowed views into the CopyInput buffer, so this
+    /// scatters pointers without copying any row bytes. Rows with a
+    /// negative shard go to every shard, like Shard::All.
+    pub fn scatter(&self, shards: usize) -> Vec<Vec<&[u8]>> {
+        let mut writes = vec![vec![]; shards];
+
+        for row in self.rows() {
+            if row.shard < 0 {
+                for write in writes.iter_mut() {
+                    write.push(row.data());
+                }
+            } else if let Some(write) = writes.get_mut(row.shard as usize) {
+                write.push(row.data());
+            }
+        }
+
+        writes
+    }
+
     /// Deallocate this structure.
     ///
     /// # Safety
@@ -239,3 +345,146 @@ impl std::fmt::Debug for CopyOutput {
             .finish()
     }
 }
+
+impl CopyRing {
+    /// Allocate a ring with at least the requested number of slots,
+    /// rounded up to a power of two.
+    pub fn new(capacity: usize) -> Self {
+        let capacity = capacity.max(1).next_power_of_two();
+        let layout = Layout::array::<CopyRow>(capacity).unwrap();
+        let slots = unsafe { alloc_zeroed(layout) as *mut CopyRow };
+
+        Self {
+            capacity: capacity as i32,
+            slots,
+            head: 0,
+            tail: 0,
+        }
+    }
+
+    /// The head and tail indexes are written from different threads:
+    /// the plugin advances head while pgDog drains and advances tail.
+    /// All accesses go through atomics to make that safe.
+    fn head(&self) -> &AtomicU64 {
+        unsafe { AtomicU64::from_ptr(&self.head as *const u64 as *mut u64) }
+    }
+
+    fn tail(&self) -> &AtomicU64 {
+        unsafe { AtomicU64::from_ptr(&self.tail as *const u64 as *mut u64) }
+    }
+
+    /// Push a row into the ring. Returns false if the ring is full.
+    ///
+    /// Only one thread (the plugin) may push at a time.
+    pub fn push(&self, row: CopyRow) -> bool {
+        let head = self.head().load(Ordering::Relaxed);
+        let tail = self.tail().load(Ordering::Acquire);
+
+        if head - tail == self.capacity as u64 {
+            return false;
+        }
+
+        unsafe {
+            *self.slots.add((head & (self.capacity as u64 - 1)) as usize) = row;
+        }
+        self.head().store(head + 1, Ordering::Release);
+
+        true
+    }
+
+    /// Pop the oldest completed row off the ring, freeing its slot
+    /// for reuse.
+    ///
+    /// Only one thread (pgDog's drain) may pop at a time.
+    pub fn pop(&self) -> Option<CopyRow> {
+        let tail = self.tail().load(Ordering::Relaxed);
+        let head = self.head().load(Ordering::Acquire);
+
+        if head == tail {
+            return None;
+        }
+
+        let row = unsafe { *self.slots.add((tail & (self.capacity as u64 - 1)) as usize) };
+        self.tail().store(tail + 1, Ordering::Release);
+
+        Some(row)
+    }
+
+    /// Number of completed rows waiting to be drained.
+    pub fn len(&self) -> usize {
+        (self.head().load(Ordering::Acquire) - self.tail().load(Ordering::Acquire)) as usize
+    }
+
+    /// Is the ring empty?
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Free the slot storage. Row data points into the COPY input
+    /// buffer, so there's nothing to free per row.
+    ///
+    /// # Safety
+    ///
+    /// Call this only after the COPY statement finished and every
+    /// slot has been drained.
+    pub unsafe fn deallocate(&mut self) {
+        let layout = Layout::array::<CopyRow>(self.capacity as usize).unwrap();
+        dealloc(self.slots as *mut u8, layout);
+        self.slots = null_mut();
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_copy_ring() {
+        let mut ring = CopyRing::new(3);
+        assert_eq!(ring.capacity, 4);
+        assert!(ring.is_empty());
+
+        let data = b"1,test@test.com\n";
+        for shard in 0..4 {
+            assert!(ring.push(CopyRow::new(data, shard)));
+        }
+        assert!(!ring.push(CopyRow::new(data, 4)));
+        assert_eq!(ring.len(), 4);
+
+        // Draining frees slots for reuse; indexes keep growing
+        // and wrap around the slot array.
+        for shard in 0..4 {
+            let row = ring.pop().unwrap();
+            assert_eq!(row.shard, shard);
+            assert_eq!(row.data(), data);
+            assert!(ring.push(CopyRow::new(data, shard + 4)));
+        }
+
+        assert_eq!(ring.len(), 4);
+        assert_eq!(ring.pop().unwrap().shard, 4);
+
+        unsafe { ring.deallocate() };
+    }
+
+    #[test]
+    fn test_copy_scatter() {
+        let data = b"1,one\n2,two\n3,three\n";
+
+        // Borrowed views into the input buffer: same pointers, no copy.
+        let rows = [
+            CopyRow::borrowed(&data[0..6], 1),
+            CopyRow::borrowed(&data[6..12], 0),
+            CopyRow::borrowed(&data[12..20], -1),
+        ];
+        assert!(rows.iter().all(|row| row.is_borrowed()));
+
+        let output = CopyOutput::new(&rows);
+        let writes = output.scatter(2);
+
+        assert_eq!(writes[0], [&data[6..12], &data[12..20]]);
+        assert_eq!(writes[1], [&data[0..6], &data[12..20]]);
+        assert_eq!(writes[0][0].as_ptr(), data[6..].as_ptr());
+
+        unsafe { output.deallocate() };
+    }
+}
@@ -0,0 +1,126 @@
+//! Lock-free statistics slots for plugins.
+//!
+//! Plugins record per-shard routing counts, cache hit rates and the
+//! like with a single relaxed atomic increment: no locks, no
+//! syscalls. Each slot sits on its own cache line so counters
+//! incremented from different threads don't false-share. pgDog
+//! aggregates the slots into its stats surface by name.
+//!
+//! Every binary linking this crate — pgDog, Rust plugins embedding
+//! it, C plugins linking the shared library — carries its own copy
+//! of the registry, so plugin-side registration forwards to the
+//! host's copy through the entry points pgDog installs at load time
+//! (see [`crate::c_api::pgdog_install_host_api`]).
+#![allow(non_upper_case_globals)]
+
+use std::ffi::CString;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+
+/// One counter, padded to a cache line.
+#[repr(C, align(64))]
+struct Slot {
+    value: AtomicU64,
+}
+
+/// Registered counters, in registration order. Slots are leaked so
+/// the pointers handed to plugins stay valid for the life of the
+/// process; the mutex only guards registration, never increments.
+static COUNTERS: Mutex<Vec<(String, &'static Slot)>> = Mutex::new(Vec::new());
+
+/// Get the counter with this name, registering it on first use.
+///
+/// Calling again with the same name returns the same slot, so
+/// plugins can resolve counters lazily without double-counting.
+pub fn counter(name: &str) -> &'static AtomicU64 {
+    // In a plugin, this copy of the registry isn't the one pgDog
+    // reads: forward to the host's when its entry points have been
+    // installed. The host's own copy never has them installed and
+    // registers locally below.
+    if let Some(stats_counter) = crate::c_api::host_api().and_then(|host| host.stats_counter) {
+        if let Ok(name) = CString::new(name) {
+            let slot = unsafe { stats_counter(name.as_ptr()) };
+            if !slot.is_null() {
+                // SAFETY: host slots are leaked and stay valid for
+                // the life of the process.
+                return unsafe { AtomicU64::from_ptr(slot) };
+            }
+        }
+    }
+
+    let mut counters = COUNTERS.lock().unwrap();
+
+    if let Some((_, slot)) = counters.iter().find(|(n, _)| n == name) {
+        return &slot.value;
+    }
+
+    let slot: &'static Slot = Box::leak(Box::new(Slot {
+        value: AtomicU64::new(0),
+    }));
+    counters.push((name.to_owned(), slot));
+
+    &slot.value
+}
+
+/// Snapshot all counters, in registration order.
+pub fn counters() -> Vec<(String, u64)> {
+    COUNTERS
+        .lock()
+        .unwrap()
+        .iter()
+        .map(|(name, slot)| (name.clone(), slot.value.load(Ordering::Relaxed)))
+        .collect()
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_counters() {
+        let hits = counter("test_cache_hits");
+        hits.fetch_add(3, Ordering::Relaxed);
+
+        // Same name, same slot.
+        counter("test_cache_hits").fetch_add(1, Ordering::Relaxed);
+
+        let snapshot = counters();
+        let (_, value) = snapshot
+            .iter()
+            .find(|(name, _)| name == "test_cache_hits")
+            .unwrap();
+        assert_eq!(*value, 4);
+
+        assert_eq!(std::mem::align_of::<Slot>(), 64);
+    }
+
+    #[test]
+    fn test_host_forwarding() {
+        static HOST_SLOT: AtomicU64 = AtomicU64::new(0);
+
+        // Resolves only the name this test registers; everything
+        // else falls back to the local registry, so concurrently
+        // running tests aren't redirected.
+        unsafe extern "C" fn resolver(name: *const std::os::raw::c_char) -> *mut u64 {
+            if std::ffi::CStr::from_ptr(name).to_bytes() == b"test_host_counter" {
+                HOST_SLOT.as_ptr()
+            } else {
+                std::ptr::null_mut()
+            }
+        }
+
+        crate::c_api::pgdog_install_host_api(crate::bindings::HostApi {
+            stats_counter: Some(resolver),
+            error_register: None,
+        });
+
+        counter("test_host_counter").fetch_add(2, Ordering::Relaxed);
+        assert_eq!(HOST_SLOT.load(Ordering::Relaxed), 2);
+
+        // Names the host doesn't resolve still register locally.
+        counter("test_fallback_counter").fetch_add(1, Ordering::Relaxed);
+        assert!(counters()
+            .iter()
+            .any(|(name, _)| name == "test_fallback_counter"));
+    }
+}
@@ -0,0 +1,139 @@
+//! Static error registry.
+//!
+//! Plugins that reject queries — rate limiters, firewalls — return
+//! the same handful of errors for every rejection. Building and
+//! freeing four heap strings per denied query is malloc pressure at
+//! exactly the wrong time, so plugins register their errors once at
+//! `pgdog_init()` time and reference them by id afterwards. pgDog
+//! resolves the id once and caches the encoded ErrorResponse.
+//!
+//! Ids index the host's registry: every binary linking this crate
+//! carries its own copy, so plugin-side registration forwards
+//! through the entry points pgDog installs at load time (see
+//! [`crate::c_api::pgdog_install_host_api`]).
+#![allow(non_upper_case_globals)]
+
+use std::ffi::CString;
+use std::sync::Mutex;
+
+use crate::bindings::Error;
+
+/// Registered errors, indexed by id. Append-only and never freed:
+/// the `Error` pointers handed out by [`error_lookup`] stay valid
+/// for the life of the process.
+static ERRORS: Mutex<Vec<RegisteredError>> = Mutex::new(Vec::new());
+
+struct RegisteredError {
+    severity: CString,
+    code: CString,
+    message: CString,
+    detail: Option<CString>,
+}
+
+/// Register an error and get its id back.
+///
+/// Returns `None` if any of the strings contain a NUL byte.
+pub fn error_register(
+    severity: &str,
+    code: &str,
+    message: &str,
+    detail: Option<&str>,
+) -> Option<i32> {
+    // In a plugin, this copy of the registry isn't the one pgDog
+    // resolves StaticError ids in: forward to the host's when its
+    // entry points have been installed, so the id indexes the
+    // registry [`error_lookup`] reads on the host side. The host's
+    // own copy never has them installed and registers locally below.
+    if let Some(register) = crate::c_api::host_api().and_then(|host| host.error_register) {
+        let severity = CString::new(severity).ok()?;
+        let code = CString::new(code).ok()?;
+        let message = CString::new(message).ok()?;
+        let detail = match detail {
+            Some(detail) => Some(CString::new(detail).ok()?),
+            None => None,
+        };
+
+        let id = unsafe {
+            register(
+                severity.as_ptr(),
+                code.as_ptr(),
+                message.as_ptr(),
+                detail
+                    .as_ref()
+                    .map(|detail| detail.as_ptr())
+                    .unwrap_or(std::ptr::null()),
+            )
+        };
+
+        return (id >= 0).then_some(id);
+    }
+
+    let error = RegisteredError {
+        severity: CString::new(severity).ok()?,
+        code: CString::new(code).ok()?,
+        message: CString::new(message).ok()?,
+        detail: match detail {
+            Some(detail) => Some(CString::new(detail).ok()?),
+            None => None,
+        },
+    };
+
+    let mut errors = ERRORS.lock().unwrap();
+    errors.push(error);
+
+    Some(errors.len() as i32 - 1)
+}
+
+/// Look up a registered error by id.
+///
+/// The pointers in the returned `Error` point into the registry and
+/// remain valid until the process exits; the caller must not free
+/// them.
+pub fn error_lookup(id: i32) -> Option<Error> {
+    let errors = ERRORS.lock().unwrap();
+    let error = errors.get(usize::try_from(id).ok()?)?;
+
+    Some(Error {
+        severity: error.severity.as_ptr() as *mut _,
+        code: error.code.as_ptr() as *mut _,
+        message: error.message.as_ptr() as *mut _,
+        detail: error
+            .detail
+            .as_ref()
+            .map(|detail| detail.as_ptr() as *mut _)
+            .unwrap_or(std::ptr::null_mut()),
+    })
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+    use std::ffi::CStr;
+
+    #[test]
+    fn test_error_registry() {
+        let id = error_register(
+            "ERROR",
+            "53300",
+            "too many connections",
+            Some("rate limit exceeded"),
+        )
+        .unwrap();
+        let error = error_lookup(id).unwrap();
+
+        unsafe {
+            assert_eq!(CStr::from_ptr(error.code).to_str().unwrap(), "53300");
+            assert_eq!(
+                CStr::from_ptr(error.message).to_str().unwrap(),
+                "too many connections"
+            );
+        }
+
+        let no_detail = error_register("ERROR", "57014", "statement timeout", None).unwrap();
+        assert!(no_detail > id);
+        assert!(error_lookup(no_detail).unwrap().detail.is_null());
+
+        assert!(error_lookup(i32::MAX).is_none());
+        assert!(error_lookup(-1).is_none());
+    }
+}
@@ -1,22 +1,64 @@
 //! Plugin input helpers.
 #![allow(non_upper_case_globals)]
 use crate::bindings::{self, *};
+use std::ffi::c_void;
+use std::ptr::null_mut;
 
 impl bindings::Input {
     /// Create new plugin input.
-    pub fn new_query(config: Config, input: RoutingInput) -> Self {
+    pub fn new_query(config_generation: u64, input: RoutingInput) -> Self {
         Self {
-            config,
+            config_generation,
             input,
             input_type: InputType_ROUTING_INPUT,
+            complete: None,
+            context: null_mut(),
         }
     }
 
-    pub fn new_copy(config: Config, input: RoutingInput) -> Self {
+    pub fn new_copy(config_generation: u64, input: RoutingInput) -> Self {
         Self {
-            config,
+            config_generation,
             input,
             input_type: InputType_COPY_INPUT,
+            complete: None,
+            context: null_mut(),
+        }
+    }
+
+    pub fn new_pipeline(config_generation: u64, input: RoutingInput) -> Self {
+        Self {
+            config_generation,
+            input,
+            input_type: InputType_PIPELINE_INPUT,
+            complete: None,
+            context: null_mut(),
+        }
+    }
+
+    /// Attach a completion callback for PENDING decisions.
+    ///
+    /// Plugins may return PENDING from this input and deliver the
+    /// final Output through the callback when their lookup finishes.
+    pub fn with_completion(mut self, complete: RouteComplete, context: *mut c_void) -> Self {
+        self.complete = complete;
+        self.context = context;
+        self
+    }
+
+    /// Deliver an asynchronously computed decision.
+    ///
+    /// Called by plugins, exactly once, after returning PENDING for
+    /// this input. Safe to call from any thread. Returns false if
+    /// pgDog didn't offer a completion callback; the plugin must
+    /// then decide synchronously.
+    pub fn deliver(&self, output: Output) -> bool {
+        match self.complete {
+            Some(complete) => {
+                unsafe { complete(self.context, output) };
+                true
+            }
+            None => false,
         }
     }
 
@@ -29,7 +71,8 @@ impl bindings::Input {
     ///
     /// This is for internal pgDog usage only.
     pub unsafe fn deallocate(&self) {
-        self.config.deallocate();
+        // The config snapshot is owned by the registry and outlives
+        // the input; nothing to free here anymore.
     }
 
     /// Get query if this is a routing input.
@@ -48,6 +91,15 @@ impl bindings::Input {
             None
         }
     }
+
+    /// Get pipeline input, if any.
+    pub fn pipeline(&self) -> Option<Pipeline> {
+        if self.input_type == InputType_PIPELINE_INPUT {
+            Some(unsafe { self.input.pipeline })
+        } else {
+            None
+        }
+    }
 }
 
 impl RoutingInput {
@@ -60,4 +112,9 @@ impl RoutingInput {
     pub fn copy(copy: CopyInput) -> Self {
         Self { copy }
     }
+
+    /// Create pipeline routing input.
+    pub fn pipeline(pipeline: Pipeline) -> Self {
+        Self { pipeline }
+    }
 }
@@ -4,15 +4,22 @@
 pub mod bindings;
 
 pub mod c_api;
+pub mod cache;
 pub mod config;
 pub mod copy;
+pub mod counter;
+pub mod error;
 pub mod input;
 pub mod order_by;
 pub mod output;
 pub mod parameter;
+pub mod pipeline;
 pub mod plugin;
+pub mod predicate;
 pub mod query;
 pub mod route;
+pub mod scan;
+pub mod shardmap;
 
 pub use bindings::*;
 pub use c_api::*;
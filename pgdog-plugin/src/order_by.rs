@@ -3,7 +3,7 @@ use std::{
     ptr::null_mut,
 };
 
-use crate::{OrderBy, OrderByDirection};
+use crate::{OrderBy, OrderByDirection, OrderByType, OrderByType_ORDER_BY_UNKNOWN};
 
 impl OrderBy {
     pub(crate) fn drop(&self) {
@@ -20,6 +20,7 @@ impl OrderBy {
             column_name: column_name.into_raw(),
             column_index: -1,
             direction,
+            data_type: OrderByType_ORDER_BY_UNKNOWN,
         }
     }
 
@@ -29,9 +30,23 @@ impl OrderBy {
             column_name: null_mut(),
             column_index: index as i32,
             direction,
+            data_type: OrderByType_ORDER_BY_UNKNOWN,
         }
     }
 
+    /// Tag the sort key with its resolved data type. pgDog then
+    /// compares binary column values directly when merging sorted
+    /// shard streams, instead of decoding generically.
+    pub fn with_data_type(mut self, data_type: OrderByType) -> Self {
+        self.data_type = data_type;
+        self
+    }
+
+    /// Resolved data type of the sort key.
+    pub fn data_type(&self) -> OrderByType {
+        self.data_type
+    }
+
     /// Get column name if any.
     pub fn name(&self) -> Option<&str> {
         if self.column_name.is_null() || self.column_index >= 0 {
@@ -1,6 +1,10 @@
 //! Plugin output helpers.
 #![allow(non_upper_case_globals)]
 use crate::bindings::*;
+use crate::c_api::pgdog_arena_free;
+use std::alloc::{dealloc, Layout};
+use std::ffi::c_void;
+use std::ptr::null_mut;
 
 impl std::fmt::Debug for Output {
     fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
@@ -17,6 +21,8 @@ impl Output {
         Self {
             decision: RoutingDecision_NO_DECISION,
             output: RoutingOutput::new_route(Route::unknown()),
+            cache_ttl_ms: 0,
+            arena: null_mut(),
         }
     }
 
@@ -28,6 +34,8 @@ impl Output {
         Output {
             decision: RoutingDecision_FORWARD,
             output: RoutingOutput::new_route(route),
+            cache_ttl_ms: 0,
+            arena: null_mut(),
         }
     }
 
@@ -36,6 +44,8 @@ impl Output {
         Output {
             decision: RoutingDecision_COPY,
             output: RoutingOutput::new_copy(copy),
+            cache_ttl_ms: 0,
+            arena: null_mut(),
         }
     }
 
@@ -44,9 +54,65 @@ impl Output {
         Output {
             decision: RoutingDecision_COPY_ROWS,
             output: RoutingOutput::new_copy_rows(output),
+            cache_ttl_ms: 0,
+            arena: null_mut(),
         }
     }
 
+    /// The route will be delivered through the input's completion
+    /// callback once the plugin's lookup finishes. Only return this
+    /// for inputs that carry a callback.
+    pub fn pending() -> Self {
+        Self {
+            decision: RoutingDecision_PENDING,
+            output: RoutingOutput::new_route(Route::unknown()),
+            cache_ttl_ms: 0,
+            arena: null_mut(),
+        }
+    }
+
+    /// Reject the query with an error registered at `pgdog_init()`
+    /// time. Allocates nothing; use this on rejection hot paths.
+    pub fn new_static_error(id: i32) -> Output {
+        Output {
+            decision: RoutingDecision_ERROR_STATIC,
+            output: RoutingOutput::new_static_error(StaticError { id }),
+            cache_ttl_ms: 0,
+            arena: null_mut(),
+        }
+    }
+
+    /// Route a whole pipeline, one route per statement.
+    pub fn new_forward_pipeline(routes: &[Route]) -> Output {
+        Output {
+            decision: RoutingDecision_FORWARD_PIPELINE,
+            output: RoutingOutput::new_pipeline(PipelineOutput::new(routes)),
+            cache_ttl_ms: 0,
+            arena: null_mut(),
+        }
+    }
+
+    /// Attach the arena this output's memory was allocated from.
+    /// pgDog will free the arena, and with it the entire output,
+    /// in one shot after the result has been sent.
+    pub fn with_arena(mut self, arena: *mut c_void) -> Self {
+        self.arena = arena;
+        self
+    }
+
+    /// Allow pgDog to reuse this decision for queries with the same
+    /// fingerprint for `ttl_ms` milliseconds. Pass a negative value
+    /// to cache the decision until the plugin is reloaded.
+    pub fn cache(mut self, ttl_ms: i32) -> Self {
+        self.cache_ttl_ms = ttl_ms;
+        self
+    }
+
+    /// Can this decision be memoized by statement fingerprint?
+    pub fn cacheable(&self) -> bool {
+        self.cache_ttl_ms != 0
+    }
+
     /// Get route determined by the plugin.
     pub fn route(&self) -> Option<Route> {
         match self.decision {
@@ -73,11 +139,44 @@ impl Output {
         }
     }
 
+    /// Get the intercepted result, if any.
+    pub fn intercept(&self) -> Option<Intercept> {
+        if self.decision == RoutingDecision_INTERCEPT {
+            Some(unsafe { self.output.intercept })
+        } else {
+            None
+        }
+    }
+
+    /// Get the registered error, resolved from the registry.
+    pub fn static_error(&self) -> Option<Error> {
+        if self.decision == RoutingDecision_ERROR_STATIC {
+            crate::error::error_lookup(unsafe { self.output.static_error.id })
+        } else {
+            None
+        }
+    }
+
+    /// Get pipeline routes if any.
+    pub fn pipeline_routes(&self) -> Option<PipelineOutput> {
+        if self.decision == RoutingDecision_FORWARD_PIPELINE {
+            Some(unsafe { self.output.pipeline })
+        } else {
+            None
+        }
+    }
+
     /// # Safety
     ///
     /// Don't use this function unless you're cleaning up plugin
     /// output.
     pub unsafe fn deallocate(&self) {
+        // Arena-backed outputs are freed in one shot.
+        if !self.arena.is_null() {
+            pgdog_arena_free(self.arena);
+            return;
+        }
+
         if self.decision == RoutingDecision_FORWARD {
             self.output.route.deallocate();
         }
@@ -87,5 +186,44 @@ impl Output {
         if self.decision == RoutingDecision_COPY_ROWS {
             self.output.copy_rows.deallocate();
         }
+        if self.decision == RoutingDecision_FORWARD_PIPELINE {
+            self.output.pipeline.deallocate();
+        }
+        if self.decision == RoutingDecision_INTERCEPT {
+            self.output.intercept.deallocate();
+        }
+    }
+}
+
+impl Intercept {
+    /// Wire-ready bytes for the whole result, if the plugin
+    /// pre-encoded them with `pgdog_row_preencode`. pgDog sends
+    /// these with a single vectored write instead of re-framing
+    /// the rows.
+    pub fn encoded(&self) -> Option<&[u8]> {
+        if self.encoded.is_null() {
+            None
+        } else {
+            unsafe {
+                Some(std::slice::from_raw_parts(
+                    self.encoded as *const u8,
+                    self.encoded_len as usize,
+                ))
+            }
+        }
+    }
+
+    /// Free the pre-encoded buffer, if any. The row structures are
+    /// owned by the plugin (or its arena) and are not touched.
+    ///
+    /// # Safety
+    ///
+    /// Should only be called once by pgDog, after the result has
+    /// been sent.
+    pub unsafe fn deallocate(&self) {
+        if !self.encoded.is_null() {
+            let layout = Layout::array::<u8>(self.encoded_len as usize).unwrap();
+            dealloc(self.encoded as *mut u8, layout);
+        }
     }
 }
@@ -50,4 +50,101 @@ impl Parameter {
 
         slice
     }
+
+    /// Decode the parameter as a 64-bit integer.
+    ///
+    /// Handles both formats without allocating: text values are
+    /// parsed as decimal, binary values are big-endian and accepted
+    /// at int2, int4 and int8 widths. The result can feed straight
+    /// into the sharding hash.
+    pub fn as_int8(&self) -> Option<i64> {
+        if self.format == 0 {
+            return self.as_str()?.trim().parse().ok();
+        }
+
+        let bytes = self.as_bytes();
+        match bytes.len() {
+            2 => Some(i16::from_be_bytes(bytes.try_into().unwrap()) as i64),
+            4 => Some(i32::from_be_bytes(bytes.try_into().unwrap()) as i64),
+            8 => Some(i64::from_be_bytes(bytes.try_into().unwrap())),
+            _ => None,
+        }
+    }
+
+    /// Decode the parameter as a 32-bit integer.
+    pub fn as_int4(&self) -> Option<i32> {
+        if self.format == 0 {
+            return self.as_str()?.trim().parse().ok();
+        }
+
+        let bytes = self.as_bytes();
+        match bytes.len() {
+            2 => Some(i16::from_be_bytes(bytes.try_into().unwrap()) as i32),
+            4 => Some(i32::from_be_bytes(bytes.try_into().unwrap())),
+            _ => None,
+        }
+    }
+
+    /// Decode the parameter as a UUID.
+    ///
+    /// Binary values are the 16 raw bytes; text values are parsed
+    /// as hex, with or without dashes. Returns the bytes in network
+    /// order, ready for hash_bytes_extended.
+    pub fn as_uuid(&self) -> Option<[u8; 16]> {
+        if self.format != 0 {
+            return self.as_bytes().try_into().ok();
+        }
+
+        let text = self.as_str()?.trim();
+        let mut digits = text
+            .bytes()
+            .filter(|b| *b != b'-')
+            .map(|b| (b as char).to_digit(16).map(|digit| digit as u8));
+
+        let mut bytes = [0u8; 16];
+        for byte in bytes.iter_mut() {
+            let hi = digits.next()??;
+            let lo = digits.next()??;
+            *byte = (hi << 4) | lo;
+        }
+
+        if digits.next().is_some() {
+            return None;
+        }
+
+        Some(bytes)
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_typed_accessors() {
+        let text = Parameter::new(0, b"12345");
+        let binary = Parameter::new(1, &12345i64.to_be_bytes());
+        let int4 = Parameter::new(1, &12345i32.to_be_bytes());
+
+        assert_eq!(text.as_int8(), Some(12345));
+        assert_eq!(binary.as_int8(), Some(12345));
+        assert_eq!(int4.as_int8(), Some(12345));
+        assert_eq!(int4.as_int4(), Some(12345));
+        assert_eq!(text.as_uuid(), None);
+
+        let uuid = [
+            0x5e, 0x9e, 0xe2, 0x4c, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa,
+            0xbb, 0xcc,
+        ];
+        let text_uuid = Parameter::new(0, b"5e9ee24c-1122-3344-5566-778899aabbcc");
+        let binary_uuid = Parameter::new(1, &uuid);
+
+        assert_eq!(text_uuid.as_uuid(), Some(uuid));
+        assert_eq!(binary_uuid.as_uuid(), Some(uuid));
+        assert_eq!(text_uuid.as_int8(), None);
+
+        for mut param in [text, binary, int4, text_uuid, binary_uuid] {
+            unsafe { param.deallocate() };
+        }
+    }
 }
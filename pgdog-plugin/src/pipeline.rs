@@ -0,0 +1,87 @@
+//! Pipeline routing helpers.
+#![allow(non_upper_case_globals)]
+
+use std::{
+    alloc::{alloc, dealloc, Layout},
+    ptr::copy,
+    slice::from_raw_parts,
+};
+
+use crate::bindings::*;
+
+impl Pipeline {
+    /// Create pipeline input from statements.
+    ///
+    /// The slice is borrowed; it must outlive the plugin call.
+    pub fn new(queries: &[Query]) -> Self {
+        Self {
+            num_queries: queries.len() as i32,
+            queries: queries.as_ptr(),
+        }
+    }
+
+    /// Get statements in the pipeline.
+    pub fn queries(&self) -> &[Query] {
+        if self.queries.is_null() {
+            &[]
+        } else {
+            unsafe { from_raw_parts(self.queries, self.num_queries as usize) }
+        }
+    }
+}
+
+impl PipelineOutput {
+    /// Pipeline output from routes, one per statement.
+    pub fn new(routes: &[Route]) -> Self {
+        let layout = Layout::array::<Route>(routes.len()).unwrap();
+        unsafe {
+            let ptr = alloc(layout) as *mut Route;
+            copy(routes.as_ptr(), ptr, routes.len());
+            Self {
+                num_routes: routes.len() as i32,
+                routes: ptr,
+            }
+        }
+    }
+
+    /// Get routes.
+    pub fn routes(&self) -> &[Route] {
+        if self.routes.is_null() {
+            &[]
+        } else {
+            unsafe { from_raw_parts(self.routes, self.num_routes as usize) }
+        }
+    }
+
+    /// Free memory allocated for the routes.
+    ///
+    /// # Safety
+    ///
+    /// Should only be called once by pgDog, after the pipeline
+    /// has been routed.
+    pub unsafe fn deallocate(&self) {
+        if !self.routes.is_null() {
+            for route in self.routes() {
+                route.deallocate();
+            }
+            let layout = Layout::array::<Route>(self.num_routes as usize).unwrap();
+            dealloc(self.routes as *mut u8, layout);
+        }
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_pipeline_output() {
+        let routes = [Route::write(0), Route::read(1), Route::read_any()];
+        let output = PipelineOutput::new(&routes);
+        assert_eq!(output.routes().len(), 3);
+        assert_eq!(output.routes()[0].shard, 0);
+        assert!(output.routes()[1].is_read());
+        assert_eq!(output.routes()[2].shard, Shard_ANY);
+        unsafe { output.deallocate() };
+    }
+}
@@ -1,19 +1,37 @@
 //! Plugin interface.
 use std::ops::Deref;
+use std::sync::Arc;
 
 use crate::bindings::{self, Input, Output};
+use crate::cache::RouteCache;
 use libloading::{library_filename, Library, Symbol};
 
 /// Plugin interface.
 #[derive(Debug)]
 pub struct Plugin<'a> {
     name: String,
+    /// ABI version the plugin was compiled against.
+    api_version: Option<Symbol<'a, unsafe extern "C" fn() -> std::ffi::c_int>>,
+    /// Optional calling conventions the plugin supports.
+    capabilities: Option<Symbol<'a, unsafe extern "C" fn() -> u64>>,
     /// Initialization routine.
     init: Option<Symbol<'a, unsafe extern "C" fn()>>,
     /// Shutdown routine.
     fini: Option<Symbol<'a, unsafe extern "C" fn()>>,
     /// Route query to a shard.
     route: Option<Symbol<'a, unsafe extern "C" fn(bindings::Input) -> Output>>,
+    /// Route a batch of queries in one call.
+    route_batch: Option<
+        Symbol<'a, unsafe extern "C" fn(*const bindings::Input, *mut Output, std::ffi::c_int)>,
+    >,
+    /// Per-thread initialization routine.
+    init_thread: Option<Symbol<'a, unsafe extern "C" fn(std::ffi::c_int, std::ffi::c_int)>>,
+    /// Receive config snapshots when topology changes.
+    config_update: Option<Symbol<'a, unsafe extern "C" fn(*const bindings::Config, u64)>>,
+    /// Receive the host's registry entry points at load time.
+    install_host_api: Option<Symbol<'a, unsafe extern "C" fn(bindings::HostApi)>>,
+    /// Memoized routing decisions, by statement fingerprint.
+    cache: RouteCache,
 }
 
 impl<'a> Plugin<'a> {
@@ -25,21 +43,181 @@ impl<'a> Plugin<'a> {
 
     /// Load standard methods from the plugin library.
     pub fn load(name: &str, library: &'a Library) -> Self {
+        let api_version = unsafe { library.get(b"pgdog_api_version\0") }.ok();
+        let capabilities = unsafe { library.get(b"pgdog_capabilities\0") }.ok();
         let route = unsafe { library.get(b"pgdog_route_query\0") }.ok();
+        let route_batch = unsafe { library.get(b"pgdog_route_query_batch\0") }.ok();
         let init = unsafe { library.get(b"pgdog_init\0") }.ok();
         let fini = unsafe { library.get(b"pgdog_fini\0") }.ok();
+        let init_thread = unsafe { library.get(b"pgdog_init_thread\0") }.ok();
+        let config_update = unsafe { library.get(b"pgdog_config_update\0") }.ok();
+        let install_host_api = unsafe { library.get(b"pgdog_install_host_api\0") }.ok();
 
         Self {
             name: name.to_owned(),
+            api_version,
+            capabilities,
             route,
+            route_batch,
             init,
             fini,
+            init_thread,
+            config_update,
+            install_host_api,
+            cache: RouteCache::default(),
+        }
+    }
+
+    /// ABI version the plugin was compiled against, if it reports
+    /// one. Plugins built before the ABI was versioned don't.
+    pub fn api_version(&self) -> Option<i32> {
+        self.api_version
+            .as_ref()
+            .map(|api_version| unsafe { api_version() })
+    }
+
+    /// Calling conventions the plugin advertises, as a bitmask of
+    /// `PGDOG_CAP_*` values. Plugins without the hook are probed by
+    /// symbol presence alone.
+    pub fn capabilities(&self) -> Option<u64> {
+        self.capabilities
+            .as_ref()
+            .map(|capabilities| unsafe { capabilities() })
+    }
+
+    /// Does the plugin advertise the capability? Defaults to true
+    /// for plugins that don't implement pgdog_capabilities.
+    pub fn has_capability(&self, capability: u64) -> bool {
+        match self.capabilities() {
+            Some(capabilities) => capabilities & capability != 0,
+            None => true,
+        }
+    }
+
+    /// Perform per-thread initialization on the calling thread.
+    ///
+    /// Lets the plugin set up thread-local state and route queries
+    /// lock-free afterwards. Returns false if the plugin doesn't
+    /// implement the hook.
+    pub fn init_thread(&self, thread_id: usize, num_threads: usize) -> bool {
+        if let Some(init_thread) = &self.init_thread {
+            unsafe {
+                init_thread(thread_id as std::ffi::c_int, num_threads as std::ffi::c_int);
+            }
+            true
+        } else {
+            false
+        }
+    }
+
+    /// Install the host's registry entry points into the plugin.
+    ///
+    /// Every binary linking the plugin crate carries its own copy of
+    /// the registries; this call points the plugin's copy at the
+    /// host's, so registrations the plugin makes are the ones the
+    /// host reads. Must run before [`Self::init`], where plugins
+    /// resolve their slots. Returns false if the plugin doesn't
+    /// export the symbol.
+    pub fn install_host_api(&self, api: bindings::HostApi) -> bool {
+        if let Some(install_host_api) = &self.install_host_api {
+            unsafe {
+                install_host_api(api);
+            }
+            true
+        } else {
+            false
+        }
+    }
+
+    /// Push a new config snapshot to the plugin.
+    ///
+    /// The snapshot must stay valid until the plugin is unloaded:
+    /// plugins are allowed to cache the pointer. Memoized routing
+    /// decisions are dropped since they were made against the
+    /// previous topology.
+    ///
+    /// Returns false if the plugin doesn't implement the hook.
+    pub fn config_update(&self, config: &'static bindings::Config, generation: u64) -> bool {
+        self.cache.reset();
+
+        if let Some(config_update) = &self.config_update {
+            unsafe {
+                config_update(config, generation);
+            }
+            true
+        } else {
+            false
         }
     }
 
     /// Route query.
+    ///
+    /// If the query carries a statement fingerprint and the plugin
+    /// previously marked its decision for it as cacheable, the memoized
+    /// route is returned without calling into the shared library.
     pub fn route(&self, input: Input) -> Option<Output> {
-        self.route.as_ref().map(|route| unsafe { route(input) })
+        let query = input.query();
+        let fingerprint = query.as_ref().map(|query| query.fingerprint).unwrap_or(0);
+
+        if fingerprint != 0 {
+            if let Some(query) = query.as_ref() {
+                if let Some(output) = self.cache.get(fingerprint, query.query()) {
+                    return Some(output);
+                }
+            }
+        }
+
+        let output = self.route.as_ref().map(|route| unsafe { route(input) });
+
+        if let Some(ref output) = output {
+            if fingerprint != 0 {
+                if let Some(query) = query.as_ref() {
+                    self.cache.store(fingerprint, query.query(), output);
+                }
+            }
+        }
+
+        output
+    }
+
+    /// Look up pre-encoded wire bytes for an intercepted statement.
+    ///
+    /// Checked before an input is even built: on a hit the caller
+    /// writes the bytes to the client socket directly and the plugin
+    /// is never invoked.
+    pub fn intercept(&self, fingerprint: u64, query: &str) -> Option<Arc<Vec<u8>>> {
+        self.cache.intercept(fingerprint, query)
+    }
+
+    /// Cache the encoded wire bytes of an INTERCEPT result the
+    /// plugin marked as cacheable. The caller encodes the result
+    /// once, after routing; repeat statements with the same
+    /// fingerprint are then served from [`Self::intercept`].
+    pub fn cache_intercept(&self, fingerprint: u64, query: &str, bytes: &[u8], ttl_ms: i32) {
+        self.cache.store_intercept(fingerprint, query, bytes, ttl_ms);
+    }
+
+    /// Route a batch of queries in a single FFI crossing.
+    ///
+    /// Returns `None` if the plugin doesn't implement the batch
+    /// entrypoint. The caller should fall back to routing queries
+    /// one at a time with [`Self::route`].
+    pub fn route_batch(&self, inputs: &[Input]) -> Option<Vec<Output>> {
+        if !self.has_capability(crate::bindings::PGDOG_CAP_ROUTE_BATCH as u64) {
+            return None;
+        }
+
+        self.route_batch.as_ref().map(|route_batch| {
+            let mut outputs = vec![Output::skip(); inputs.len()];
+            unsafe {
+                route_batch(
+                    inputs.as_ptr(),
+                    outputs.as_mut_ptr(),
+                    inputs.len() as std::ffi::c_int,
+                )
+            };
+            outputs
+        })
     }
 
     /// Perform initialization.
@@ -65,9 +243,17 @@ impl<'a> Plugin<'a> {
         &self.name
     }
 
-    /// Check that we have the required methods.
+    /// Check that we have the required methods and that the plugin
+    /// was built against this ABI version. The version symbol was
+    /// introduced together with a struct layout change, so a plugin
+    /// that doesn't export it was built against the old layout and
+    /// is rejected, not assumed compatible.
     pub fn valid(&self) -> bool {
         self.route.is_some()
+            && self
+                .api_version()
+                .map(|version| version == crate::bindings::PGDOG_API_VERSION as i32)
+                .unwrap_or(false)
     }
 }
 
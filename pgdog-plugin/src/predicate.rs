@@ -0,0 +1,54 @@
+use crate::bindings::ShardingKeyPredicate;
+
+use std::ffi::{CStr, CString};
+use std::ptr::null;
+
+impl ShardingKeyPredicate {
+    /// Value inline in the query text, e.g. `id = 5`.
+    pub fn constant(value: CString) -> Self {
+        Self {
+            len: value.as_bytes().len() as i32,
+            value: value.into_raw(),
+            parameter: -1,
+        }
+    }
+
+    /// Value bound as a parameter, e.g. `id = $1`.
+    pub fn parameter(index: usize) -> Self {
+        Self {
+            len: 0,
+            value: null(),
+            parameter: index as i32,
+        }
+    }
+
+    /// Get the value if it's inline in the query text.
+    pub fn value(&self) -> Option<&str> {
+        if self.value.is_null() {
+            None
+        } else {
+            unsafe { CStr::from_ptr(self.value) }.to_str().ok()
+        }
+    }
+
+    /// Get the parameter index if the value is bound separately.
+    pub fn parameter_index(&self) -> Option<usize> {
+        if self.parameter < 0 {
+            None
+        } else {
+            Some(self.parameter as usize)
+        }
+    }
+
+    /// Free memory allocated for the value, if any.
+    ///
+    /// # Safety
+    ///
+    /// This is not to be used by plugins.
+    /// This is for internal pgDog usage only.
+    pub(crate) unsafe fn deallocate(&self) {
+        if !self.value.is_null() {
+            drop(CString::from_raw(self.value as *mut _))
+        }
+    }
+}
@@ -1,4 +1,6 @@
-use crate::bindings::{Parameter, Query};
+use crate::bindings::{
+    Parameter, Query, ShardingKeyPredicate, StatementKind, StatementKind_STATEMENT_UNKNOWN,
+};
 
 use std::alloc::{alloc, dealloc, Layout};
 use std::ffi::{CStr, CString};
@@ -18,9 +20,125 @@ impl Query {
             query: query.into_raw(),
             num_parameters: 0,
             parameters: null(),
+            fingerprint: 0,
+            statement_kind: StatementKind_STATEMENT_UNKNOWN,
+            table_name: null(),
+            num_sharding_key_predicates: 0,
+            sharding_key_predicates: null(),
         }
     }
 
+    /// Clone this query into freshly owned allocations.
+    ///
+    /// The copy shares nothing with the original: it stays valid
+    /// after the caller frees its buffers and is released with
+    /// [`Self::deallocate`]. Used by pgDog's routing worker pool to
+    /// detach a job's lifetime from the client awaiting it.
+    pub fn deep_copy(&self) -> Self {
+        let mut owned = Self::new(CString::new(self.query()).unwrap());
+        owned.statement_kind = self.statement_kind;
+        owned.fingerprint = self.fingerprint;
+
+        if let Some(table_name) = self.table_name() {
+            owned.set_table_name(CString::new(table_name).unwrap());
+        }
+
+        if self.num_parameters > 0 {
+            let parameters = self
+                .parameters()
+                .iter()
+                .map(|param| Parameter::new(param.format as i16, param.as_bytes()))
+                .collect::<Vec<_>>();
+            owned.set_parameters(&parameters);
+        }
+
+        if self.num_sharding_key_predicates > 0 {
+            let predicates = self
+                .sharding_key_predicates()
+                .iter()
+                .map(|predicate| match predicate.parameter_index() {
+                    Some(index) => ShardingKeyPredicate::parameter(index),
+                    None => ShardingKeyPredicate::constant(
+                        CString::new(predicate.value().unwrap_or("")).unwrap(),
+                    ),
+                })
+                .collect::<Vec<_>>();
+            owned.set_sharding_key_predicates(&predicates);
+        }
+
+        owned
+    }
+
+    /// Set the statement kind computed by pgDog's parser. Used
+    /// internally by pgDog.
+    pub fn set_statement_kind(&mut self, statement_kind: StatementKind) {
+        self.statement_kind = statement_kind;
+    }
+
+    /// Statement kind, `STATEMENT_UNKNOWN` if not precomputed.
+    pub fn statement_kind(&self) -> StatementKind {
+        self.statement_kind
+    }
+
+    /// Set the first table referenced by the statement. Used
+    /// internally by pgDog.
+    pub fn set_table_name(&mut self, table_name: CString) {
+        self.table_name = table_name.into_raw();
+    }
+
+    /// First table referenced by the statement, if pgDog computed it.
+    pub fn table_name(&self) -> Option<&str> {
+        if self.table_name.is_null() {
+            None
+        } else {
+            unsafe { CStr::from_ptr(self.table_name) }.to_str().ok()
+        }
+    }
+
+    /// Set equality predicates on the sharding column. Used
+    /// internally by pgDog.
+    pub fn set_sharding_key_predicates(&mut self, predicates: &[ShardingKeyPredicate]) {
+        let layout = Layout::array::<ShardingKeyPredicate>(predicates.len()).unwrap();
+        let ptr = unsafe { alloc(layout) };
+
+        unsafe {
+            copy(
+                predicates.as_ptr(),
+                ptr as *mut ShardingKeyPredicate,
+                predicates.len(),
+            );
+        }
+        self.sharding_key_predicates = ptr as *const ShardingKeyPredicate;
+        self.num_sharding_key_predicates = predicates.len() as i32;
+    }
+
+    /// Get sharding key predicate at offset if one exists.
+    pub fn sharding_key_predicate(&self, index: usize) -> Option<ShardingKeyPredicate> {
+        if index < self.num_sharding_key_predicates as usize {
+            unsafe { Some(*self.sharding_key_predicates.add(index)) }
+        } else {
+            None
+        }
+    }
+
+    /// Get all sharding key predicates, if any.
+    pub fn sharding_key_predicates(&self) -> Vec<ShardingKeyPredicate> {
+        (0..self.num_sharding_key_predicates)
+            .map(|i| self.sharding_key_predicate(i as usize).unwrap())
+            .collect()
+    }
+
+    /// Set the statement fingerprint. Used internally by pgDog
+    /// to memoize routing decisions for repeat statements.
+    pub fn set_fingerprint(&mut self, fingerprint: u64) {
+        self.fingerprint = fingerprint;
+    }
+
+    /// Statement fingerprint, or 0 if the caller didn't compute one.
+    pub fn fingerprint(&self) -> u64 {
+        self.fingerprint
+    }
+
     /// Set parameters on this query. This is used internally
     /// by pgDog to construct this structure.
     pub fn set_parameters(&mut self, params: &[Parameter]) {
@@ -76,5 +194,61 @@ impl Query {
                 self.parameters = null();
             }
         }
+
+        if !self.table_name.is_null() {
+            unsafe { drop(CString::from_raw(self.table_name as *mut _)) }
+            self.table_name = null();
+        }
+
+        if !self.sharding_key_predicates.is_null() {
+            for index in 0..self.num_sharding_key_predicates {
+                if let Some(predicate) = self.sharding_key_predicate(index as usize) {
+                    predicate.deallocate();
+                }
+            }
+            let layout =
+                Layout::array::<ShardingKeyPredicate>(self.num_sharding_key_predicates as usize)
+                    .unwrap();
+            unsafe {
+                dealloc(self.sharding_key_predicates as *mut u8, layout);
+                self.sharding_key_predicates = null();
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_deep_copy() {
+        let mut query = Query::new(CString::new("SELECT * FROM users WHERE id = $1").unwrap());
+        query.set_fingerprint(1234);
+        query.set_table_name(CString::new("users").unwrap());
+        query.set_parameters(&[Parameter::new(0, b"5")]);
+        query.set_sharding_key_predicates(&[
+            ShardingKeyPredicate::parameter(0),
+            ShardingKeyPredicate::constant(CString::new("5").unwrap()),
+        ]);
+
+        let mut copy = query.deep_copy();
+
+        // Same contents, none of the same allocations.
+        assert_eq!(copy.query(), query.query());
+        assert_ne!(copy.query, query.query);
+        assert_eq!(copy.fingerprint(), 1234);
+        assert_eq!(copy.table_name(), Some("users"));
+        assert_eq!(copy.parameter(0).unwrap().as_str(), Some("5"));
+        assert_ne!(copy.parameters, query.parameters);
+        assert_eq!(copy.sharding_key_predicate(0).unwrap().parameter_index(), Some(0));
+        assert_eq!(copy.sharding_key_predicate(1).unwrap().value(), Some("5"));
+
+        unsafe { query.deallocate() };
+
+        // The copy outlives the original's buffers.
+        assert_eq!(copy.query(), "SELECT * FROM users WHERE id = $1");
+
+        unsafe { copy.deallocate() };
     }
 }
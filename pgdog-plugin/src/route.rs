@@ -23,6 +23,16 @@ impl RoutingOutput {
     pub fn new_copy_rows(copy_rows: CopyOutput) -> RoutingOutput {
         RoutingOutput { copy_rows }
     }
+
+    /// Create new pipeline output.
+    pub fn new_pipeline(pipeline: PipelineOutput) -> RoutingOutput {
+        RoutingOutput { pipeline }
+    }
+
+    /// Reference an error registered with the static error registry.
+    pub fn new_static_error(static_error: StaticError) -> RoutingOutput {
+        RoutingOutput { static_error }
+    }
 }
 
 impl Route {
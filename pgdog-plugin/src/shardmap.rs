@@ -0,0 +1,217 @@
+//! Memory-mapped shard directory.
+//!
+//! Hash sharding computes the shard from the key; range and list
+//! sharded deployments need a directory instead. Loading tens of
+//! millions of tenant→shard entries into a heap hash table costs
+//! gigabytes of RSS and tens of seconds of startup per process.
+//!
+//! A shard map is a sorted, fixed-width (key, shard) file. Opening
+//! one is an mmap: startup is instant, the memory is shared across
+//! processes via the page cache, and a lookup is a cache-friendly
+//! branchless binary search — O(log n) with a handful of cache
+//! misses, no allocation and no locks.
+#![allow(non_upper_case_globals)]
+
+use std::ffi::CString;
+use std::io::{Error, ErrorKind, Result, Write};
+use std::path::Path;
+
+/// File magic, followed by the entry count as a little-endian u64.
+const MAGIC: &[u8; 8] = b"PGDOGSM1";
+
+/// Header size: magic + entry count.
+const HEADER: usize = 16;
+
+/// One directory entry. Fixed width so the file can be generated
+/// by any tool that can sort and write 16-byte records.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+struct Entry {
+    key: i64,
+    shard: i32,
+    _pad: i32,
+}
+
+/// A memory-mapped shard directory.
+#[derive(Debug)]
+pub struct ShardMap {
+    ptr: *mut libc::c_void,
+    len: usize,
+    entries: *const Entry,
+    count: usize,
+}
+
+/// SAFETY: the mapping is read-only and lives until drop.
+unsafe impl Send for ShardMap {}
+unsafe impl Sync for ShardMap {}
+
+impl ShardMap {
+    /// Memory-map a shard directory file.
+    ///
+    /// The file must be sorted by key, ascending. That's verified
+    /// lazily by lookups, not here: opening a 40-million-entry map
+    /// should cost an mmap, not a scan.
+    pub fn open(path: impl AsRef<Path>) -> Result<Self> {
+        let path = CString::new(path.as_ref().as_os_str().as_encoded_bytes())
+            .map_err(|_| Error::new(ErrorKind::InvalidInput, "path contains a NUL byte"))?;
+
+        unsafe {
+            let fd = libc::open(path.as_ptr(), libc::O_RDONLY);
+            if fd < 0 {
+                return Err(Error::last_os_error());
+            }
+
+            let mut stat: libc::stat = std::mem::zeroed();
+            if libc::fstat(fd, &mut stat) != 0 {
+                let err = Error::last_os_error();
+                libc::close(fd);
+                return Err(err);
+            }
+
+            let len = stat.st_size as usize;
+            let ptr = libc::mmap(
+                std::ptr::null_mut(),
+                len.max(1),
+                libc::PROT_READ,
+                libc::MAP_SHARED,
+                fd,
+                0,
+            );
+            libc::close(fd);
+
+            if ptr == libc::MAP_FAILED {
+                return Err(Error::last_os_error());
+            }
+
+            let mut map = ShardMap {
+                ptr,
+                len,
+                entries: (ptr as *const u8).add(HEADER) as *const Entry,
+                count: 0,
+            };
+
+            if len < HEADER || &*(ptr as *const [u8; 8]) != MAGIC {
+                return Err(Error::new(ErrorKind::InvalidData, "not a shard map file"));
+            }
+
+            let count =
+                u64::from_le_bytes(*((ptr as *const u8).add(8) as *const [u8; 8])) as usize;
+            if len != HEADER + count * std::mem::size_of::<Entry>() {
+                return Err(Error::new(ErrorKind::InvalidData, "shard map truncated"));
+            }
+
+            map.count = count;
+            Ok(map)
+        }
+    }
+
+    /// Look up the shard for a key.
+    ///
+    /// Branchless binary search: the comparison updates the lower
+    /// bound with a conditional move instead of a branch, so the
+    /// hard-to-predict "which half" decision never flushes the
+    /// pipeline and the cost is the ~log2(n) cache misses alone.
+    pub fn lookup(&self, key: i64) -> Option<i32> {
+        if self.count == 0 {
+            return None;
+        }
+
+        let mut low = 0usize;
+        let mut size = self.count;
+
+        while size > 1 {
+            let half = size / 2;
+            let mid = low + half;
+            // Compiles to cmov: no branch on the comparison.
+            low = if unsafe { (*self.entries.add(mid)).key } <= key {
+                mid
+            } else {
+                low
+            };
+            size -= half;
+        }
+
+        let entry = unsafe { *self.entries.add(low) };
+        if entry.key == key {
+            Some(entry.shard)
+        } else {
+            None
+        }
+    }
+
+    /// Number of entries in the directory.
+    pub fn len(&self) -> usize {
+        self.count
+    }
+
+    /// Is the directory empty?
+    pub fn is_empty(&self) -> bool {
+        self.count == 0
+    }
+
+    /// Write a shard directory file from (key, shard) pairs. The
+    /// pairs must be sorted by key. Used by tooling and tests; the
+    /// format is simple enough to generate from a COPY of the
+    /// directory table.
+    pub fn write(path: impl AsRef<Path>, entries: &[(i64, i32)]) -> Result<()> {
+        debug_assert!(entries.windows(2).all(|pair| pair[0].0 < pair[1].0));
+
+        let mut file = std::fs::File::create(path)?;
+        file.write_all(MAGIC)?;
+        file.write_all(&(entries.len() as u64).to_le_bytes())?;
+
+        for (key, shard) in entries {
+            file.write_all(&key.to_le_bytes())?;
+            file.write_all(&shard.to_le_bytes())?;
+            file.write_all(&[0u8; 4])?;
+        }
+
+        Ok(())
+    }
+}
+
+impl Drop for ShardMap {
+    fn drop(&mut self) {
+        unsafe {
+            libc::munmap(self.ptr, self.len.max(1));
+        }
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_shardmap() {
+        let path = std::env::temp_dir().join("pgdog_shardmap_test.map");
+        let entries = (0..10_000i64)
+            .map(|tenant| (tenant * 3, (tenant % 8) as i32))
+            .collect::<Vec<_>>();
+        ShardMap::write(&path, &entries).unwrap();
+
+        let map = ShardMap::open(&path).unwrap();
+        assert_eq!(map.len(), entries.len());
+
+        for (key, shard) in &entries {
+            assert_eq!(map.lookup(*key), Some(*shard));
+        }
+
+        // Misses: below, between and above the keys.
+        assert_eq!(map.lookup(-1), None);
+        assert_eq!(map.lookup(1), None);
+        assert_eq!(map.lookup(i64::MAX), None);
+
+        std::fs::remove_file(&path).unwrap();
+    }
+
+    #[test]
+    fn test_shardmap_invalid() {
+        let path = std::env::temp_dir().join("pgdog_shardmap_invalid.map");
+        std::fs::write(&path, b"not a shard map").unwrap();
+        assert!(ShardMap::open(&path).is_err());
+        std::fs::remove_file(&path).unwrap();
+
+        assert!(ShardMap::open("/nonexistent/shardmap").is_err());
+    }
+}
@@ -2,9 +2,11 @@ use std::process::Command;
 
 fn main() {
     println!("cargo:rerun-if-changed=src/frontend/router/sharding/hashfn.c");
+    println!("cargo:rerun-if-changed=src/frontend/router/sharding/postgres_hash.h");
 
     cc::Build::new()
         .file("src/frontend/router/sharding/hashfn.c")
+        .include("src/frontend/router/sharding")
         .compile("postgres_hash");
 
     let output = Command::new("git").args(["rev-parse", "HEAD"]).output();
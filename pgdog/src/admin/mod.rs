@@ -18,6 +18,7 @@ pub mod show_clients;
 pub mod show_config;
 pub mod show_lists;
 pub mod show_peers;
+pub mod show_plugins;
 pub mod show_pools;
 pub mod show_prepared_statements;
 pub mod show_query_cache;
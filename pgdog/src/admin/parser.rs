@@ -4,8 +4,9 @@ use super::{
     pause::Pause, prelude::Message, reconnect::Reconnect, reload::Reload,
     reset_query_cache::ResetQueryCache, set::Set, setup_schema::SetupSchema,
     show_clients::ShowClients, show_config::ShowConfig, show_lists::ShowLists,
-    show_peers::ShowPeers, show_pools::ShowPools, show_prepared_statements::ShowPreparedStatements,
-    show_query_cache::ShowQueryCache, show_servers::ShowServers, show_stats::ShowStats,
+    show_peers::ShowPeers, show_plugins::ShowPlugins, show_pools::ShowPools,
+    show_prepared_statements::ShowPreparedStatements, show_query_cache::ShowQueryCache,
+    show_servers::ShowServers, show_stats::ShowStats,
     show_version::ShowVersion, shutdown::Shutdown, Command, Error,
 };
 
@@ -22,6 +23,7 @@ pub enum ParseResult {
     ShowServers(ShowServers),
     ShowPeers(ShowPeers),
     ShowQueryCache(ShowQueryCache),
+    ShowPlugins(ShowPlugins),
     ResetQueryCache(ResetQueryCache),
     ShowStats(ShowStats),
     ShowVersion(ShowVersion),
@@ -47,6 +49,7 @@ impl ParseResult {
             ShowServers(show_servers) => show_servers.execute().await,
             ShowPeers(show_peers) => show_peers.execute().await,
             ShowQueryCache(show_query_cache) => show_query_cache.execute().await,
+            ShowPlugins(show_plugins) => show_plugins.execute().await,
             ResetQueryCache(reset_query_cache) => reset_query_cache.execute().await,
             ShowStats(show_stats) => show_stats.execute().await,
             ShowVersion(show_version) => show_version.execute().await,
@@ -72,6 +75,7 @@ impl ParseResult {
             ShowServers(show_servers) => show_servers.name(),
             ShowPeers(show_peers) => show_peers.name(),
             ShowQueryCache(show_query_cache) => show_query_cache.name(),
+            ShowPlugins(show_plugins) => show_plugins.name(),
             ResetQueryCache(reset_query_cache) => reset_query_cache.name(),
             ShowStats(show_stats) => show_stats.name(),
             ShowVersion(show_version) => show_version.name(),
@@ -105,6 +109,7 @@ impl Parser {
                 "servers" => ParseResult::ShowServers(ShowServers::parse(&sql)?),
                 "peers" => ParseResult::ShowPeers(ShowPeers::parse(&sql)?),
                 "query_cache" => ParseResult::ShowQueryCache(ShowQueryCache::parse(&sql)?),
+                "plugins" => ParseResult::ShowPlugins(ShowPlugins::parse(&sql)?),
                 "stats" => ParseResult::ShowStats(ShowStats::parse(&sql)?),
                 "version" => ParseResult::ShowVersion(ShowVersion::parse(&sql)?),
                 "lists" => ParseResult::ShowLists(ShowLists::parse(&sql)?),
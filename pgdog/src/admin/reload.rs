@@ -2,6 +2,7 @@
 
 use super::prelude::*;
 use crate::backend::databases::reload;
+use crate::plugin;
 
 pub struct Reload;
 
@@ -17,6 +18,8 @@ impl Command for Reload {
 
     async fn execute(&self) -> Result<Vec<Message>, Error> {
         let _ = reload(); // TODO: error check.
+        // Pick up freshly deployed plugin builds without a restart.
+        let _ = plugin::reload();
         Ok(vec![])
     }
 }
@@ -0,0 +1,47 @@
+//! SHOW PLUGINS.
+
+use crate::plugin::stats;
+
+use super::prelude::*;
+
+pub struct ShowPlugins;
+
+#[async_trait]
+impl Command for ShowPlugins {
+    fn name(&self) -> String {
+        "SHOW PLUGINS".into()
+    }
+
+    fn parse(_: &str) -> Result<Self, Error> {
+        Ok(Self)
+    }
+
+    async fn execute(&self) -> Result<Vec<Message>, Error> {
+        let mut messages = vec![RowDescription::new(&[
+            Field::text("plugin"),
+            Field::numeric("calls"),
+            Field::numeric("calls_per_sec"),
+            Field::numeric("p50_us"),
+            Field::numeric("p99_us"),
+            Field::numeric("p999_us"),
+            Field::numeric("no_decision"),
+        ])
+        .message()?];
+
+        for (name, stats) in stats::all() {
+            let mut dr = DataRow::new();
+
+            dr.add(name)
+                .add(stats.calls())
+                .add(stats.calls_per_second())
+                .add(stats.percentile(0.5).as_micros())
+                .add(stats.percentile(0.99).as_micros())
+                .add(stats.percentile(0.999).as_micros())
+                .add(stats.no_decision());
+
+            messages.push(dr.message()?);
+        }
+
+        Ok(messages)
+    }
+}
@@ -5,12 +5,24 @@ use std::{cmp::Ordering, collections::VecDeque};
 use crate::{
     frontend::router::parser::{Aggregate, OrderBy},
     net::{
-        messages::{DataRow, FromBytes, Message, Protocol, ToBytes, Vector},
+        messages::{DataRow, Datum, FromBytes, Message, Protocol, ToBytes, Vector},
         Decoder,
     },
 };
 
-use super::Aggregates;
+use super::{merge, Aggregates};
+
+/// Sort key decoded once per row, so the sort doesn't re-decode
+/// column values on every comparison.
+#[derive(Debug)]
+enum SortKey {
+    /// Decoded column value.
+    Datum(Datum),
+    /// Distance to the reference vector for vector searches.
+    Distance(Option<f64>),
+    /// Column missing or not resolved.
+    None,
+}
 
 /// Sort and aggregate rows received from multiple shards.
 #[derive(Default, Debug)]
@@ -68,41 +80,55 @@ impl Buffer {
             };
         }
 
-        // Sort rows.
-        let order_by = move |a: &DataRow, b: &DataRow| -> Ordering {
-            for col in cols.iter() {
-                let index = col.index();
-                let asc = col.asc();
-                let index = if let Some(index) = index {
-                    index
-                } else {
-                    continue;
-                };
-                let left = a.get_column(index, decoder);
-                let right = b.get_column(index, decoder);
+        if cols.is_empty() {
+            return;
+        }
 
-                let ordering = match (left, right) {
-                    (Ok(Some(left)), Ok(Some(right))) => {
-                        // Handle the special vector case.
-                        if let OrderBy::AscVectorL2(_, vector) = col {
-                            let left: Option<Vector> = left.value.try_into().ok();
-                            let right: Option<Vector> = right.value.try_into().ok();
-
-                            if let (Some(left), Some(right)) = (left, right) {
-                                let left = left.distance_l2(vector);
-                                let right = right.distance_l2(vector);
-
-                                left.partial_cmp(&right)
-                            } else {
-                                Some(Ordering::Equal)
+        // Decode sort keys once per row, instead of once per
+        // comparison.
+        let keyed = std::mem::take(&mut self.buffer)
+            .into_iter()
+            .map(|row| {
+                let key = cols
+                    .iter()
+                    .map(|col| match col.index() {
+                        Some(index) => match row.get_column(index, decoder) {
+                            Ok(Some(column)) => {
+                                // Handle the special vector case.
+                                if let OrderBy::AscVectorL2(_, vector) = col {
+                                    let value: Option<Vector> = column.value.try_into().ok();
+                                    SortKey::Distance(value.map(|value| value.distance_l2(vector)))
+                                } else {
+                                    SortKey::Datum(column.value)
+                                }
                             }
-                        } else if asc {
-                            left.value.partial_cmp(&right.value)
+                            _ => SortKey::None,
+                        },
+                        None => SortKey::None,
+                    })
+                    .collect::<Vec<_>>();
+
+                (key, row)
+            })
+            .collect::<Vec<_>>();
+
+        let compare = |a: &(Vec<SortKey>, DataRow), b: &(Vec<SortKey>, DataRow)| -> Ordering {
+            for ((left, right), col) in a.0.iter().zip(b.0.iter()).zip(cols.iter()) {
+                let ordering = match (left, right) {
+                    // Rows whose vector is NULL or undecodable keep
+                    // their relative order, like comparing the rows
+                    // directly did.
+                    (SortKey::Distance(Some(left)), SortKey::Distance(Some(right))) => {
+                        left.partial_cmp(right)
+                    }
+                    (SortKey::Distance(_), SortKey::Distance(_)) => Some(Ordering::Equal),
+                    (SortKey::Datum(left), SortKey::Datum(right)) => {
+                        if col.asc() {
+                            left.partial_cmp(right)
                         } else {
-                            right.value.partial_cmp(&left.value)
+                            right.partial_cmp(left)
                         }
                     }
-
                     _ => Some(Ordering::Equal),
                 };
 
@@ -114,7 +140,15 @@ impl Buffer {
             Ordering::Equal
         };
 
-        self.buffer.make_contiguous().sort_by(order_by);
+        // Each shard's stream is already sorted, so the buffer
+        // breaks into a few long runs; the loser tree merges them
+        // in log2(runs) comparisons per row instead of the full
+        // sort's log2(rows).
+        let runs = merge::natural_runs(keyed, &compare);
+        self.buffer = merge::merge_runs(runs, &compare)
+            .into_iter()
+            .map(|(_, row)| row)
+            .collect();
     }
 
     /// Execute aggregate functions.
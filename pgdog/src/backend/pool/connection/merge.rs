@@ -0,0 +1,157 @@
+//! K-way merge of sorted runs.
+//!
+//! Cross-shard ORDER BY results arrive as one sorted stream per
+//! shard, so the sorting buffer decomposes into a few long sorted
+//! runs. Merging them with a loser tree costs log2(k) comparisons
+//! per output row, where k is the number of runs, instead of the
+//! log2(n) a full sort pays per row.
+
+use std::cmp::Ordering;
+use std::collections::VecDeque;
+
+/// Merge sorted runs into one sorted sequence.
+///
+/// The comparator must match the order of the runs themselves.
+/// Stable: ties are broken by run index, so rows keep their
+/// arrival order.
+pub(super) fn merge_runs<T>(
+    mut runs: Vec<VecDeque<T>>,
+    cmp: impl Fn(&T, &T) -> Ordering,
+) -> VecDeque<T> {
+    match runs.len() {
+        0 => return VecDeque::new(),
+        1 => return runs.pop().unwrap(),
+        _ => (),
+    }
+
+    let mut out = VecDeque::with_capacity(runs.iter().map(|run| run.len()).sum());
+
+    // Pad to a power of two so every leaf plays a run; empty runs
+    // lose every match.
+    runs.resize_with(runs.len().next_power_of_two(), VecDeque::new);
+    let k = runs.len();
+
+    // Run a beats run b if a's head row sorts first.
+    let beats = |a: usize, b: usize, runs: &[VecDeque<T>]| -> bool {
+        match (runs[a].front(), runs[b].front()) {
+            (Some(x), Some(y)) => match cmp(x, y) {
+                Ordering::Less => true,
+                Ordering::Greater => false,
+                Ordering::Equal => a < b,
+            },
+            (Some(_), None) => true,
+            (None, Some(_)) => false,
+            (None, None) => a < b,
+        }
+    };
+
+    // Play the initial tournament bottom-up. node[1..k] remember
+    // the loser of the match played there; node[0] the champion.
+    // The leaf for run i sits at position k + i.
+    let mut winners = vec![0usize; 2 * k];
+    for (i, winner) in winners.iter_mut().enumerate().skip(k) {
+        *winner = i - k;
+    }
+    let mut node = vec![0usize; k];
+    for i in (1..k).rev() {
+        let (a, b) = (winners[2 * i], winners[2 * i + 1]);
+        if beats(a, b, &runs) {
+            winners[i] = a;
+            node[i] = b;
+        } else {
+            winners[i] = b;
+            node[i] = a;
+        }
+    }
+    node[0] = winners[1];
+
+    loop {
+        let winner = node[0];
+        let row = match runs[winner].pop_front() {
+            Some(row) => row,
+            // The champion run is empty: everything is merged.
+            None => break,
+        };
+        out.push_back(row);
+
+        // Replay only the matches on the path from the winner's
+        // leaf back to the root.
+        let mut current = winner;
+        let mut i = (k + winner) / 2;
+        while i >= 1 {
+            if beats(node[i], current, &runs) {
+                std::mem::swap(&mut node[i], &mut current);
+            }
+            i /= 2;
+        }
+        node[0] = current;
+    }
+
+    out
+}
+
+/// Split a sequence into its natural sorted runs.
+///
+/// Rows from each shard arrive in sorted order but interleaved
+/// with the other shards, so k shard streams break into a small
+/// multiple of k runs.
+pub(super) fn natural_runs<T>(
+    rows: impl IntoIterator<Item = T>,
+    cmp: impl Fn(&T, &T) -> Ordering,
+) -> Vec<VecDeque<T>> {
+    let mut runs: Vec<VecDeque<T>> = vec![];
+
+    for row in rows {
+        match runs.last_mut() {
+            Some(run) if cmp(run.back().unwrap(), &row) != Ordering::Greater => {
+                run.push_back(row)
+            }
+            _ => runs.push(VecDeque::from([row])),
+        }
+    }
+
+    runs
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_merge_runs() {
+        let runs = vec![
+            VecDeque::from([1, 4, 7, 10]),
+            VecDeque::from([]),
+            VecDeque::from([2, 5, 8]),
+            VecDeque::from([3, 6, 9]),
+            VecDeque::from([0]),
+        ];
+
+        let merged = merge_runs(runs, i32::cmp);
+        assert_eq!(merged, (0..11).collect::<VecDeque<_>>());
+
+        assert!(merge_runs::<i32>(vec![], i32::cmp).is_empty());
+        assert_eq!(
+            merge_runs(vec![VecDeque::from([3, 2, 1])], i32::cmp),
+            VecDeque::from([3, 2, 1])
+        );
+    }
+
+    #[test]
+    fn test_natural_runs() {
+        // Two sorted streams, interleaved.
+        let rows = vec![1, 3, 5, 2, 4, 6, 0];
+        let runs = natural_runs(rows, i32::cmp);
+        assert_eq!(
+            runs,
+            vec![
+                VecDeque::from([1, 3, 5]),
+                VecDeque::from([2, 4, 6]),
+                VecDeque::from([0]),
+            ]
+        );
+
+        let merged = merge_runs(runs, i32::cmp);
+        assert_eq!(merged, (0..7).collect::<VecDeque<_>>());
+    }
+}
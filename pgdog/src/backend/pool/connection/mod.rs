@@ -30,6 +30,7 @@ use std::{mem::replace, time::Duration};
 pub mod aggregate;
 pub mod binding;
 pub mod buffer;
+pub mod merge;
 pub mod mirror;
 pub mod multi_shard;
 
@@ -349,6 +349,14 @@ pub struct General {
     /// Mirror queue size.
     #[serde(default = "General::mirror_queue")]
     pub mirror_queue: usize,
+    /// Run plugin routing on this many dedicated threads instead of
+    /// inline on the async workers. 0 (the default) routes inline.
+    #[serde(default)]
+    pub plugin_threads: usize,
+    /// Pin the dedicated plugin threads to cores, one thread per
+    /// core starting at core 0.
+    #[serde(default)]
+    pub plugin_pin_cores: bool,
     #[serde(default)]
     pub auth_type: AuthType,
 }
@@ -444,6 +452,8 @@ impl Default for General {
             dry_run: bool::default(),
             idle_timeout: Self::idle_timeout(),
             mirror_queue: Self::mirror_queue(),
+            plugin_threads: 0,
+            plugin_pin_cores: false,
             auth_type: AuthType::default(),
         }
     }
@@ -1,10 +1,19 @@
 //! Memory-safe wrapper around the FFI binding to Query.
+use fnv::FnvHasher;
+use pg_query::{protobuf::Node, NodeEnum, ParseResult};
+use pgdog_plugin::bindings::{
+    ShardingKeyPredicate, StatementKind, StatementKind_STATEMENT_DELETE,
+    StatementKind_STATEMENT_INSERT, StatementKind_STATEMENT_OTHER, StatementKind_STATEMENT_SELECT,
+    StatementKind_STATEMENT_UNKNOWN, StatementKind_STATEMENT_UPDATE,
+};
 use pgdog_plugin::Query;
 use std::{
     ffi::CString,
+    hash::Hasher,
     ops::{Deref, DerefMut},
 };
 
+use super::parser::{Key, WhereClause};
 use super::Error;
 
 /// Memory-safe wrapper around the FFI binding to Query.
@@ -28,9 +37,75 @@ impl DerefMut for Request {
 impl Request {
     /// New query request.
     pub fn new(query: &str) -> Result<Self, Error> {
-        Ok(Self {
-            query: Query::new(CString::new(query.as_bytes())?),
-        })
+        // Cheap statement fingerprint used to memoize plugin
+        // routing decisions for repeat queries.
+        let mut hasher = FnvHasher::default();
+        hasher.write(query.as_bytes());
+
+        let mut request = Query::new(CString::new(query.as_bytes())?);
+        request.set_fingerprint(hasher.finish());
+
+        Ok(Self { query: request })
+    }
+
+    /// Attach statement metadata the router computed while parsing
+    /// the query, so plugins don't have to tokenize it again.
+    pub fn with_metadata(
+        mut self,
+        ast: &ParseResult,
+        sharding_column: Option<&str>,
+    ) -> Result<Self, Error> {
+        let root = ast
+            .protobuf
+            .stmts
+            .first()
+            .and_then(|stmt| stmt.stmt.as_ref())
+            .and_then(|node| node.node.as_ref());
+
+        let (kind, where_clause): (StatementKind, Option<&Option<Box<Node>>>) = match root {
+            Some(NodeEnum::SelectStmt(stmt)) => {
+                (StatementKind_STATEMENT_SELECT, Some(&stmt.where_clause))
+            }
+            Some(NodeEnum::InsertStmt(_)) => (StatementKind_STATEMENT_INSERT, None),
+            Some(NodeEnum::UpdateStmt(stmt)) => {
+                (StatementKind_STATEMENT_UPDATE, Some(&stmt.where_clause))
+            }
+            Some(NodeEnum::DeleteStmt(stmt)) => {
+                (StatementKind_STATEMENT_DELETE, Some(&stmt.where_clause))
+            }
+            Some(_) => (StatementKind_STATEMENT_OTHER, None),
+            None => (StatementKind_STATEMENT_UNKNOWN, None),
+        };
+        self.query.set_statement_kind(kind);
+
+        let tables = ast.tables();
+        let table_name = tables.first().map(|table| table.as_str());
+
+        if let Some(table_name) = table_name {
+            self.query.set_table_name(CString::new(table_name)?);
+        }
+
+        if let (Some(where_clause), Some(column)) = (where_clause, sharding_column) {
+            if let Some(where_clause) = WhereClause::new(table_name, where_clause) {
+                let predicates = where_clause
+                    .keys(table_name, column)
+                    .into_iter()
+                    .filter_map(|key| match key {
+                        Key::Constant(value) => CString::new(value)
+                            .ok()
+                            .map(ShardingKeyPredicate::constant),
+                        Key::Parameter(index) => Some(ShardingKeyPredicate::parameter(index)),
+                        Key::Null => None,
+                    })
+                    .collect::<Vec<_>>();
+
+                if !predicates.is_empty() {
+                    self.query.set_sharding_key_predicates(&predicates);
+                }
+            }
+        }
+
+        Ok(self)
     }
 
     /// Get constructed query.
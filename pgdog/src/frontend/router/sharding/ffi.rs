@@ -4,6 +4,23 @@ extern "C" {
     pub(super) fn hash_bytes_extended(k: *const u8, keylen: i64) -> u64;
     /// Special hashing function for BIGINT (i64).
     pub(super) fn hashint8extended(k: i64) -> u64;
+    /// Special hashing function for INTEGER (i32). Same result as
+    /// `hashint8extended` of the widened value, minus the fold.
+    pub(super) fn hashint4extended(k: i32) -> u64;
+    /// Special hashing function for SMALLINT (i16).
+    pub(super) fn hashint2extended(k: i16) -> u64;
     /// Combine multiple hashes into one in the case of multi-column hashing keys.
     pub(super) fn hash_combine64(a: u64, b: u64) -> u64;
+    /// Hash a batch of keys with one FFI crossing.
+    pub(super) fn hash_bytes_extended_batch(
+        keys: *const *const u8,
+        lens: *const i32,
+        out: *mut u64,
+        n: i32,
+    );
+    /// Batch variant of `hashint8extended`. Uses AVX2 when available.
+    pub(super) fn hashint8extended_batch(vals: *const i64, out: *mut u64, n: i32);
+    /// Jump consistent hash: map a hash to a shard so that growing
+    /// the shard count only moves the minimal fraction of keys.
+    pub(super) fn shard_for_key(key: u64, num_shards: i32) -> i32;
 }
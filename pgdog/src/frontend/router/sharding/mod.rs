@@ -31,6 +31,20 @@ pub fn bigint(id: i64) -> u64 {
     unsafe { ffi::hash_combine64(0, ffi::hashint8extended(id)) }
 }
 
+/// Hash `INTEGER`.
+///
+/// Same result as [`bigint`] of the widened value: Postgres folds a
+/// BIGINT into 32 bits before hashing, so the fixed-width path just
+/// skips the fold.
+pub fn int4(id: i32) -> u64 {
+    unsafe { ffi::hash_combine64(0, ffi::hashint4extended(id)) }
+}
+
+/// Hash `SMALLINT`. Same result as [`bigint`] of the widened value.
+pub fn int2(id: i16) -> u64 {
+    unsafe { ffi::hash_combine64(0, ffi::hashint2extended(id)) }
+}
+
 /// Hash UUID.
 pub fn uuid(uuid: Uuid) -> u64 {
     unsafe {
@@ -41,6 +55,54 @@ pub fn uuid(uuid: Uuid) -> u64 {
     }
 }
 
+/// Map a hash to a shard with jump consistent hash.
+///
+/// Unlike `hash % shards`, growing from N to N + K shards moves only
+/// K / (N + K) of the keys, so a reshard is an incremental migration
+/// instead of a near-full one. Opt-in: the modulo mapping stays the
+/// default because existing deployments placed their data with it.
+pub fn shard_for_key(hash: u64, shards: usize) -> usize {
+    unsafe { ffi::shard_for_key(hash, shards as i32) as usize }
+}
+
+/// Hash a batch of `BIGINT` values with one FFI crossing.
+///
+/// Results are identical to calling [`bigint`] once per value.
+pub fn bigint_batch(ids: &[i64]) -> Vec<u64> {
+    let mut hashes = vec![0u64; ids.len()];
+    unsafe {
+        ffi::hashint8extended_batch(ids.as_ptr(), hashes.as_mut_ptr(), ids.len() as i32);
+    }
+    for hash in hashes.iter_mut() {
+        *hash = unsafe { ffi::hash_combine64(0, *hash) };
+    }
+    hashes
+}
+
+/// Hash a batch of UUIDs with one FFI crossing.
+///
+/// Results are identical to calling [`uuid`] once per value.
+pub fn uuid_batch(uuids: &[Uuid]) -> Vec<u64> {
+    let keys = uuids
+        .iter()
+        .map(|uuid| uuid.as_bytes().as_ptr())
+        .collect::<Vec<_>>();
+    let lens = vec![16i32; uuids.len()];
+    let mut hashes = vec![0u64; uuids.len()];
+    unsafe {
+        ffi::hash_bytes_extended_batch(
+            keys.as_ptr(),
+            lens.as_ptr(),
+            hashes.as_mut_ptr(),
+            uuids.len() as i32,
+        );
+    }
+    for hash in hashes.iter_mut() {
+        *hash = unsafe { ffi::hash_combine64(0, *hash) };
+    }
+    hashes
+}
+
 /// Shard a string value, parsing out a BIGINT, UUID, or vector.
 ///
 /// TODO: This is really not great, we should pass in the type oid
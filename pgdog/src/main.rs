@@ -62,16 +62,24 @@ fn main() -> Result<(), Box<dyn std::error::Error>> {
 
     plugin::load_from_config()?;
 
+    // Opt-in dedicated routing threads, isolated from the I/O
+    // workers below.
+    let general = &config.config.general;
+    plugin::executor::start(general.plugin_threads, general.plugin_pin_cores);
+
     let runtime = match config.config.general.workers {
         0 => {
             let mut binding = Builder::new_current_thread();
             binding.enable_all();
+            // Single-threaded runtime executes on this thread.
+            plugin::init_thread(1);
             binding
         }
         workers => {
             info!("spawning {} workers", workers);
             let mut builder = Builder::new_multi_thread();
             builder.worker_threads(workers).enable_all();
+            builder.on_thread_start(move || plugin::init_thread(workers));
             builder
         }
     }
@@ -0,0 +1,157 @@
+//! Dedicated routing worker pool.
+//!
+//! By default plugin calls execute inline on whatever async worker
+//! thread owns the client connection: a slow `pgdog_route_query`
+//! stalls unrelated connections sharing that thread, and plugin code
+//! bounces across every core, trashing its thread-local caches.
+//!
+//! Opt in with `plugin_threads` in `pgdog.toml` to run plugin calls
+//! on dedicated threads instead. Each worker owns its own handoff
+//! queue — clients pick a worker round-robin and await completion on
+//! a oneshot — and can be pinned to a core with `plugin_pin_cores`,
+//! which combined with the per-thread init hook gives plugins stable
+//! cache-warm cores and isolates routing latency from I/O threads.
+
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::thread;
+
+use once_cell::sync::OnceCell;
+use pgdog_plugin::bindings::{Input, Output, RoutingInput};
+use tokio::sync::{mpsc, oneshot};
+use tracing::{info, warn};
+
+/// Per-worker queue depth. A full queue means routing is falling
+/// behind; the client falls back to routing inline rather than wait.
+const QUEUE_DEPTH: usize = 1024;
+
+/// One routing request in flight.
+struct Job {
+    input: Input,
+    reply: oneshot::Sender<Option<Output>>,
+}
+
+/// SAFETY: the Query inside the Input is a deep copy owned by the
+/// job (see `route`), so it stays valid even when the awaiting
+/// future is cancelled; nothing else touches it until the worker
+/// frees it after routing.
+unsafe impl Send for Job {}
+
+impl Job {
+    /// Free the job's deep-copied query.
+    fn free(&self) {
+        if let Some(mut query) = self.input.query() {
+            unsafe { query.deallocate() };
+        }
+    }
+}
+
+/// Handoff queues, one per worker, created once at startup.
+static QUEUES: OnceCell<Vec<mpsc::Sender<Job>>> = OnceCell::new();
+
+/// Round-robin worker selection.
+static NEXT_WORKER: AtomicUsize = AtomicUsize::new(0);
+
+/// Start the routing worker pool. Called once at startup, after
+/// plugins are loaded; a no-op if `threads` is zero.
+pub fn start(threads: usize, pin_cores: bool) {
+    if threads == 0 {
+        return;
+    }
+
+    let mut queues = Vec::with_capacity(threads);
+
+    for thread_id in 0..threads {
+        let (tx, mut rx) = mpsc::channel::<Job>(QUEUE_DEPTH);
+        queues.push(tx);
+
+        thread::Builder::new()
+            .name(format!("plugin-router-{}", thread_id))
+            .spawn(move || {
+                if pin_cores {
+                    pin_to_core(thread_id);
+                }
+                super::init_thread(threads);
+
+                while let Some(job) = rx.blocking_recv() {
+                    let output = super::route(job.input);
+                    job.free();
+                    // The client may have given up (e.g. disconnect);
+                    // its output still has to be freed.
+                    if let Err(Some(output)) = job.reply.send(output) {
+                        unsafe { output.deallocate() };
+                    }
+                }
+            })
+            .expect("spawn plugin router thread");
+    }
+
+    let _ = QUEUES.set(queues);
+
+    info!(
+        "plugin routing on {} dedicated thread(s){}",
+        threads,
+        if pin_cores { ", core-pinned" } else { "" }
+    );
+}
+
+/// Route on the worker pool, falling back to routing inline when the
+/// pool isn't running or its queues are full.
+pub async fn route(input: Input) -> Option<Output> {
+    let queues = match QUEUES.get() {
+        Some(queues) => queues,
+        None => return super::route(input),
+    };
+
+    // Only query inputs are offloaded. COPY and pipeline inputs
+    // borrow large caller-owned buffers that can't be copied into
+    // the job cheaply; routing them inline keeps the buffers alive
+    // for the duration of the call.
+    let query = match input.query() {
+        Some(query) => query,
+        None => return super::route(input),
+    };
+
+    let worker = NEXT_WORKER.fetch_add(1, Ordering::Relaxed) % queues.len();
+    let (tx, rx) = oneshot::channel();
+
+    // The job owns a deep copy of the query: this future can be
+    // cancelled (client disconnect) and the caller's buffers freed
+    // while the worker is still routing.
+    let job = Job {
+        input: Input {
+            input: RoutingInput::query(query.deep_copy()),
+            ..input
+        },
+        reply: tx,
+    };
+
+    if let Err(err) = queues[worker].try_send(job) {
+        // Queue full or worker gone: don't make a stall worse by
+        // queueing behind it.
+        err.into_inner().free();
+        return super::route(input);
+    }
+
+    rx.await.unwrap_or(None)
+}
+
+/// Pin the calling thread to a core. Workers take cores 0..N; on
+/// boxes where those cores are reserved, leave pinning off and let
+/// the scheduler place the threads.
+#[cfg(target_os = "linux")]
+fn pin_to_core(core: usize) {
+    unsafe {
+        let mut set: libc::cpu_set_t = std::mem::zeroed();
+        libc::CPU_SET(core, &mut set);
+
+        if libc::sched_setaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &set) != 0 {
+            warn!("couldn't pin plugin router thread to core {}", core);
+        }
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+fn pin_to_core(core: usize) {
+    let _ = core;
+    warn!("core pinning isn't supported on this platform");
+}
@@ -1,14 +1,212 @@
 //! pgDog plugins.
 
-use once_cell::sync::OnceCell;
+pub mod executor;
+pub mod stats;
+
+use std::collections::HashMap;
+use std::ptr::null_mut;
+use std::sync::atomic::{AtomicPtr, AtomicU64, AtomicUsize, Ordering};
+use std::sync::Arc;
+
+use arc_swap::ArcSwap;
+use once_cell::sync::Lazy;
+use parking_lot::Mutex;
+use pgdog_plugin::bindings::{
+    Config, Input, Output, RoutingDecision_NO_DECISION, RoutingDecision_PENDING,
+};
 use pgdog_plugin::libloading;
 use pgdog_plugin::libloading::Library;
 use pgdog_plugin::Plugin;
 use tokio::time::Instant;
 use tracing::{debug, error, info, warn};
 
-static LIBS: OnceCell<Vec<Library>> = OnceCell::new();
-pub static PLUGINS: OnceCell<Vec<Plugin>> = OnceCell::new();
+/// Currently active plugin generation. Swapped wholesale on reload,
+/// like the database registry: readers do a single atomic load and
+/// keep the generation alive for the duration of their call.
+static REGISTRY: Lazy<ArcSwap<Plugins>> = Lazy::new(|| ArcSwap::from_pointee(Plugins::default()));
+/// Serializes load/reload; the routing path doesn't take it.
+static LOCK: Lazy<Mutex<()>> = Lazy::new(|| Mutex::new(()));
+static CONFIG_GENERATION: AtomicU64 = AtomicU64::new(0);
+/// Latest config snapshot, replayed into freshly reloaded plugins.
+static CONFIG_SNAPSHOT: AtomicPtr<Config> = AtomicPtr::new(null_mut());
+static THREAD_COUNTER: AtomicUsize = AtomicUsize::new(0);
+
+/// One generation of loaded plugins and the shared libraries
+/// backing them.
+#[derive(Default)]
+pub struct Plugins {
+    plugins: Vec<Plugin<'static>>,
+    /// Latency histograms, parallel to `plugins`. Resolved at load
+    /// time so the routing path doesn't take the stats registry lock.
+    stats: Vec<Arc<stats::PluginStats>>,
+    /// Which plugin claimed each statement fingerprint on the first
+    /// pass over the chain. Repeat statements call only that plugin,
+    /// skipping the ones that returned NO_DECISION. Claims store the
+    /// statement text: the fingerprint is a fast non-cryptographic
+    /// hash, and a collision has to fall back to the full chain, not
+    /// call the wrong plugin.
+    claims: Mutex<HashMap<u64, Claim>>,
+    /// Owned by this generation; reclaimed in Drop, after the
+    /// plugins borrowing from them are gone.
+    libraries: Vec<*mut Library>,
+}
+
+/// Claim entry for statements no plugin made a decision for:
+/// the whole chain is skipped on repeats.
+const CLAIMED_NONE: usize = usize::MAX;
+
+/// Upper bound on claims per plugin generation. Statements with
+/// inline literals fingerprint uniquely; without a bound an ad-hoc
+/// workload grows the map for as long as the generation lives.
+/// Claims are cheap to recompute, so at capacity new ones are simply
+/// not recorded.
+const MAX_CLAIMS: usize = 10_000;
+
+/// Which plugin claimed a statement fingerprint, and the statement
+/// text the fingerprint was computed from.
+struct Claim {
+    query: String,
+    index: usize,
+}
+
+/// SAFETY: the raw library pointers are only dereferenced in Drop,
+/// which runs exactly once, on the last thread holding the Arc.
+unsafe impl Send for Plugins {}
+unsafe impl Sync for Plugins {}
+
+impl Plugins {
+    /// All plugins in this generation.
+    pub fn iter(&self) -> std::slice::Iter<'_, Plugin<'static>> {
+        self.plugins.iter()
+    }
+
+    /// Get plugin by name.
+    pub fn get(&self, name: &str) -> Option<&Plugin<'static>> {
+        self.plugins.iter().find(|plugin| plugin.name() == name)
+    }
+
+    /// Number of loaded plugins.
+    pub fn len(&self) -> usize {
+        self.plugins.len()
+    }
+
+    /// No plugins loaded.
+    pub fn is_empty(&self) -> bool {
+        self.plugins.is_empty()
+    }
+
+    /// Call one plugin, recording the sample in its latency
+    /// histogram.
+    fn route_one(&self, index: usize, input: Input) -> Option<Output> {
+        let plugin = self.plugins.get(index)?;
+
+        let now = std::time::Instant::now();
+        let output = plugin.route(input);
+        let elapsed = now.elapsed();
+
+        let no_decision = match output {
+            Some(ref output) => output.decision == RoutingDecision_NO_DECISION,
+            None => true,
+        };
+        if let Some(stats) = self.stats.get(index) {
+            stats.record(elapsed, no_decision);
+        }
+
+        output
+    }
+}
+
+impl Drop for Plugins {
+    fn drop(&mut self) {
+        // In-flight calls have drained: nobody else holds the Arc.
+        // Shut the plugins down, then unload their libraries.
+        for plugin in &self.plugins {
+            plugin.fini();
+        }
+        self.plugins.clear();
+
+        for library in self.libraries.drain(..) {
+            unsafe {
+                drop(Box::from_raw(library));
+            }
+        }
+    }
+}
+
+/// Load one generation of plugins from shared libraries.
+fn load_generation(names: &[&str]) -> Plugins {
+    let mut libraries = vec![];
+    let mut plugins = vec![];
+    let mut plugin_stats = vec![];
+
+    for name in names.iter() {
+        let library = match Plugin::library(name) {
+            Ok(library) => Box::into_raw(Box::new(library)),
+            Err(err) => {
+                error!("plugin \"{}\" failed to load: {:#?}", name, err);
+                continue;
+            }
+        };
+
+        let now = Instant::now();
+        // SAFETY: the reference lives as long as the generation;
+        // plugins are dropped before the library in Drop above.
+        let plugin = Plugin::load(name, unsafe { &*library });
+
+        if !plugin.valid() {
+            warn!(
+                "plugin \"{}\" is missing required symbols or was built against a different ABI version, skipping",
+                name
+            );
+            unsafe {
+                drop(Box::from_raw(library));
+            }
+            continue;
+        }
+
+        if let (Some(version), Some(capabilities)) = (plugin.api_version(), plugin.capabilities()) {
+            debug!(
+                "plugin \"{}\" ABI version {}, capabilities {:#x}",
+                name, version, capabilities
+            );
+        }
+        // Point the plugin's registries at ours before init, where
+        // plugins resolve their slots: every binary linking
+        // pgdog_plugin has its own copy of the registries, and this
+        // binary's is the one the stats surface reads.
+        if plugin.install_host_api(host_api()) {
+            debug!("plugin \"{}\" received host registry entry points", name);
+        }
+        if plugin.init() {
+            debug!("plugin \"{}\" initialized", name);
+        }
+
+        libraries.push(library);
+        plugin_stats.push(stats::plugin_stats(name));
+        plugins.push(plugin);
+        info!(
+            "loaded \"{}\" plugin [{:.4}ms]",
+            name,
+            now.elapsed().as_secs_f64() * 1000.0
+        );
+    }
+
+    Plugins {
+        plugins,
+        stats: plugin_stats,
+        claims: Mutex::default(),
+        libraries,
+    }
+}
+
+/// Entry points into this binary's plugin registries, installed
+/// into every plugin at load time.
+fn host_api() -> pgdog_plugin::bindings::HostApi {
+    pgdog_plugin::bindings::HostApi {
+        stats_counter: Some(pgdog_plugin::pgdog_stats_counter),
+        error_register: Some(pgdog_plugin::pgdog_error_register),
+    }
+}
 
 /// Load plugins.
 ///
@@ -17,68 +215,290 @@ pub static PLUGINS: OnceCell<Vec<Plugin>> = OnceCell::new();
 /// This should be run before Tokio is loaded since this is not thread-safe.
 ///
 pub fn load(names: &[&str]) -> Result<(), libloading::Error> {
-    if LIBS.get().is_some() {
+    let _guard = LOCK.lock();
+
+    if !REGISTRY.load().is_empty() {
         return Ok(());
-    };
+    }
 
-    let mut libs = vec![];
-    for plugin in names.iter() {
-        match Plugin::library(plugin) {
-            Ok(plugin) => libs.push(plugin),
-            Err(err) => {
-                error!("plugin \"{}\" failed to load: {:#?}", plugin, err);
+    REGISTRY.store(Arc::new(load_generation(names)));
+
+    Ok(())
+}
+
+/// Hot-reload plugins from freshly deployed shared libraries.
+///
+/// The new generation is loaded and initialized while the old one
+/// keeps serving, handed the current config snapshot, and then
+/// swapped in atomically. The old generation is finalized and its
+/// libraries unloaded once in-flight routing calls drain.
+///
+/// Threads spawned before the reload won't re-run per-thread
+/// initialization in the new generation.
+pub fn reload() -> Result<(), libloading::Error> {
+    let _guard = LOCK.lock();
+
+    let config = crate::config::config();
+    let names = config
+        .config
+        .plugins
+        .iter()
+        .map(|s| s.name.as_str())
+        .collect::<Vec<_>>();
+
+    let plugins = load_generation(&names);
+
+    // Hand the new generation the current topology before it starts
+    // serving. The snapshot is rebuilt from the loaded config so a
+    // reload picks up topology changes; if the config carries no
+    // databases, replay the last snapshot pushed.
+    match config_snapshot() {
+        Some(snapshot) => {
+            push_snapshot(&plugins, snapshot);
+        }
+        None => {
+            let snapshot = CONFIG_SNAPSHOT.load(Ordering::Acquire);
+            if !snapshot.is_null() {
+                let generation = CONFIG_GENERATION.load(Ordering::Relaxed);
+                for plugin in plugins.iter() {
+                    plugin.config_update(unsafe { &*snapshot }, generation);
+                }
             }
         }
     }
 
-    let _ = LIBS.set(libs);
+    let count = plugins.len();
+    REGISTRY.store(Arc::new(plugins));
+    info!("reloaded {} plugin(s)", count);
 
-    let mut plugins = vec![];
-    for (i, name) in names.iter().enumerate() {
-        if let Some(lib) = LIBS.get().unwrap().get(i) {
-            let now = Instant::now();
-            let plugin = Plugin::load(name, lib);
-
-            if !plugin.valid() {
-                warn!("plugin \"{}\" is missing required symbols, skipping", name);
-            } else {
-                if plugin.init() {
-                    debug!("plugin \"{}\" initialized", name);
+    Ok(())
+}
+
+/// Get the active plugin generation.
+pub fn plugins() -> Arc<Plugins> {
+    REGISTRY.load().clone()
+}
+
+/// Route a query through the plugin chain.
+///
+/// The first plugin that makes a decision wins. Each invocation is
+/// timed with the monotonic clock (a vDSO read, not a syscall) and
+/// recorded in that plugin's latency histogram, so a plugin that
+/// silently regresses shows up in SHOW PLUGINS and OpenMetrics.
+pub fn route(input: Input) -> Option<Output> {
+    let plugins = plugins();
+    let query = input.query();
+    let fingerprint = query.as_ref().map(|query| query.fingerprint).unwrap_or(0);
+    let statement = query.as_ref().map(|query| query.query()).unwrap_or("");
+
+    // For any given statement shape, the same plugins return
+    // NO_DECISION forever. Call only the plugin that claimed the
+    // fingerprint on the first pass; if none did, skip the chain.
+    // The claim only applies when the statement text matches: on a
+    // fingerprint collision the full chain runs.
+    if fingerprint != 0 {
+        let claimed = {
+            let claims = plugins.claims.lock();
+            claims
+                .get(&fingerprint)
+                .filter(|claim| claim.query == statement)
+                .map(|claim| claim.index)
+        };
+
+        match claimed {
+            Some(CLAIMED_NONE) => return None,
+            Some(index) => {
+                if let Some(output) = plugins.route_one(index, input) {
+                    if output.decision != RoutingDecision_NO_DECISION {
+                        return Some(output);
+                    }
                 }
-                plugins.push(plugin);
-                info!(
-                    "loaded \"{}\" plugin [{:.4}ms]",
-                    name,
-                    now.elapsed().as_secs_f64() * 1000.0
-                );
+                // The claim went stale (e.g. parameter-dependent
+                // decision): forget it and walk the whole chain.
+                plugins.claims.lock().remove(&fingerprint);
             }
+            None => (),
         }
     }
 
-    let _ = PLUGINS.set(plugins);
+    let claim = |index: usize| {
+        let mut claims = plugins.claims.lock();
+        if claims.len() < MAX_CLAIMS || claims.contains_key(&fingerprint) {
+            claims.insert(
+                fingerprint,
+                Claim {
+                    query: statement.to_string(),
+                    index,
+                },
+            );
+        }
+    };
 
-    Ok(())
+    for index in 0..plugins.plugins.len() {
+        if let Some(output) = plugins.route_one(index, input) {
+            if output.decision != RoutingDecision_NO_DECISION {
+                if fingerprint != 0 {
+                    claim(index);
+                }
+                return Some(output);
+            }
+        }
+    }
+
+    if fingerprint != 0 {
+        claim(CLAIMED_NONE);
+    }
+
+    None
 }
 
-/// Shutdown plugins.
-pub fn shutdown() {
-    for plugin in plugins() {
-        plugin.fini();
+/// Output delivered through a completion callback.
+///
+/// SAFETY: ownership of the plugin's allocations transfers to the
+/// receiver along with the struct; nothing else touches them.
+struct SendOutput(Output);
+unsafe impl Send for SendOutput {}
+
+/// Route a query, resolving PENDING decisions asynchronously.
+///
+/// A plugin that has to wait on external I/O (e.g. a remote shard
+/// directory) returns PENDING and delivers the final Output through
+/// the completion callback when its lookup finishes. Only this
+/// client waits; the routing thread moves on to other connections
+/// instead of blocking on the plugin's network round trip.
+pub async fn route_async(input: Input) -> Option<Output> {
+    let (tx, rx) = tokio::sync::oneshot::channel::<SendOutput>();
+    let context = Box::into_raw(Box::new(tx));
+    let input = input.with_completion(Some(deliver), context as *mut _);
+
+    match executor::route(input).await {
+        Some(output) if output.decision == RoutingDecision_PENDING => {
+            rx.await.ok().map(|output| output.0)
+        }
+        other => {
+            // Decision was synchronous: the callback wasn't called
+            // and never will be; reclaim its context.
+            drop(unsafe { Box::from_raw(context) });
+            other
+        }
+    }
+}
+
+/// Completion callback handed to plugins through the Input.
+unsafe extern "C" fn deliver(context: *mut std::ffi::c_void, output: Output) {
+    let tx = Box::from_raw(context as *mut tokio::sync::oneshot::Sender<SendOutput>);
+    // The client may have disconnected while the lookup was in
+    // flight; its output still has to be freed.
+    if let Err(output) = tx.send(SendOutput(output)) {
+        output.0.deallocate();
     }
 }
 
-/// Get plugin by name.
-pub fn plugin(name: &str) -> Option<&Plugin> {
-    PLUGINS
-        .get()
-        .unwrap()
+/// Run per-thread plugin initialization on the calling thread.
+///
+/// The runtime invokes this on every thread it spawns, before the
+/// thread routes any queries. Thread ids are assigned in spawn order,
+/// so the first `num_threads` ids cover the worker pool.
+pub fn init_thread(num_threads: usize) {
+    let thread_id = THREAD_COUNTER.fetch_add(1, Ordering::Relaxed);
+
+    for plugin in plugins().iter() {
+        if plugin.init_thread(thread_id, num_threads) {
+            debug!(
+                "plugin \"{}\" initialized thread {}",
+                plugin.name(),
+                thread_id
+            );
+        }
+    }
+}
+
+/// Push a new config snapshot to all plugins.
+///
+/// Plugins cache the pointer to the snapshot, so it has to stay valid
+/// until they're unloaded. Topology changes are rare (config reloads),
+/// so old generations are intentionally kept alive instead of
+/// synchronizing every routing call against a reload.
+pub fn update_config(config: Config) -> u64 {
+    push_snapshot(&plugins(), config)
+}
+
+/// Register a snapshot and push it to one generation of plugins.
+fn push_snapshot(plugins: &Plugins, config: Config) -> u64 {
+    let generation = CONFIG_GENERATION.fetch_add(1, Ordering::Relaxed) + 1;
+    let snapshot: &'static Config = Box::leak(Box::new(config));
+    CONFIG_SNAPSHOT.store(snapshot as *const Config as *mut Config, Ordering::Release);
+
+    // Claims were made against the previous topology.
+    plugins.claims.lock().clear();
+
+    for plugin in plugins.iter() {
+        if plugin.config_update(snapshot, generation) {
+            debug!(
+                "plugin \"{}\" received config generation {}",
+                plugin.name(),
+                generation
+            );
+        }
+    }
+
+    generation
+}
+
+/// Build a plugin config snapshot from the loaded database config.
+///
+/// The snapshot protocol carries one cluster; multi-database
+/// deployments snapshot the first configured database.
+fn config_snapshot() -> Option<Config> {
+    use pgdog_plugin::bindings::{DatabaseConfig, Role_PRIMARY, Role_REPLICA};
+    use std::ffi::CString;
+
+    let config = crate::config::config();
+    let name = &config.config.databases.first()?.name;
+
+    let databases = config
+        .config
+        .databases
         .iter()
-        .find(|&plugin| plugin.name() == name)
+        .filter(|database| &database.name == name)
+        .map(|database| {
+            DatabaseConfig::new(
+                CString::new(database.host.as_str()).unwrap(),
+                database.port,
+                match database.role {
+                    crate::config::Role::Primary => Role_PRIMARY,
+                    crate::config::Role::Replica => Role_REPLICA,
+                },
+                database.shard,
+            )
+        })
+        .collect::<Vec<_>>();
+
+    let shards = databases
+        .iter()
+        .map(|database| database.shard() + 1)
+        .max()
+        .unwrap_or(1);
+
+    Some(Config::new(
+        CString::new(name.as_str()).unwrap(),
+        &databases,
+        shards,
+    ))
 }
 
-/// Get all loaded plugins.
-pub fn plugins() -> &'static Vec<Plugin<'static>> {
-    PLUGINS.get().unwrap()
+/// Generation number of the config snapshot plugins have last seen.
+pub fn config_generation() -> u64 {
+    CONFIG_GENERATION.load(Ordering::Relaxed)
+}
+
+/// Shutdown plugins.
+pub fn shutdown() {
+    let _guard = LOCK.lock();
+
+    // Dropping the last reference finalizes the plugins and unloads
+    // their libraries.
+    REGISTRY.store(Arc::new(Plugins::default()));
 }
 
 /// Load plugins from config.
@@ -92,5 +512,14 @@ pub fn load_from_config() -> Result<(), libloading::Error> {
         .map(|s| s.name.as_str())
         .collect::<Vec<_>>();
 
-    load(plugins)
+    load(plugins)?;
+
+    // Plugins route against a registered config snapshot; without
+    // an initial push the routing plugin has no topology and skips
+    // every query.
+    if let Some(snapshot) = config_snapshot() {
+        update_config(snapshot);
+    }
+
+    Ok(())
 }
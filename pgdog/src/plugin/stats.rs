@@ -0,0 +1,141 @@
+//! Per-plugin routing latency statistics.
+//!
+//! `pgdog_route_query` is the hot path, so recording a sample is two
+//! relaxed atomic increments into a log-scale histogram; percentiles
+//! are computed lazily when the admin database or the OpenMetrics
+//! endpoint asks for them.
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+use once_cell::sync::Lazy;
+use parking_lot::Mutex;
+
+/// Number of log₂ buckets. Bucket `i` holds samples with a latency
+/// of `[2^i, 2^(i+1))` nanoseconds; 64 buckets cover any u64.
+const BUCKETS: usize = 64;
+
+/// Keyed by plugin name so history survives hot reloads.
+static STATS: Lazy<Mutex<HashMap<String, Arc<PluginStats>>>> =
+    Lazy::new(|| Mutex::new(HashMap::new()));
+
+/// Get stats for a plugin, creating them on first use.
+pub fn plugin_stats(name: &str) -> Arc<PluginStats> {
+    let mut stats = STATS.lock();
+    if let Some(stats) = stats.get(name) {
+        return stats.clone();
+    }
+
+    let entry = Arc::new(PluginStats::new());
+    stats.insert(name.to_owned(), entry.clone());
+    entry
+}
+
+/// All per-plugin stats, sorted by plugin name.
+pub fn all() -> Vec<(String, Arc<PluginStats>)> {
+    let stats = STATS.lock();
+    let mut all = stats
+        .iter()
+        .map(|(name, stats)| (name.clone(), stats.clone()))
+        .collect::<Vec<_>>();
+    all.sort_by(|a, b| a.0.cmp(&b.0));
+    all
+}
+
+/// Routing latency histogram for one plugin.
+pub struct PluginStats {
+    buckets: [AtomicU64; BUCKETS],
+    calls: AtomicU64,
+    no_decision: AtomicU64,
+    started: Instant,
+}
+
+impl PluginStats {
+    fn new() -> Self {
+        Self {
+            buckets: [0u64; BUCKETS].map(AtomicU64::new),
+            calls: AtomicU64::new(0),
+            no_decision: AtomicU64::new(0),
+            started: Instant::now(),
+        }
+    }
+
+    /// Record one routing call.
+    pub fn record(&self, elapsed: Duration, no_decision: bool) {
+        let nanos = elapsed.as_nanos() as u64;
+        let bucket = (u64::BITS - nanos.leading_zeros()).saturating_sub(1) as usize;
+
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+        self.calls.fetch_add(1, Ordering::Relaxed);
+        if no_decision {
+            self.no_decision.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    /// Total routing calls.
+    pub fn calls(&self) -> u64 {
+        self.calls.load(Ordering::Relaxed)
+    }
+
+    /// Calls that returned NO_DECISION.
+    pub fn no_decision(&self) -> u64 {
+        self.no_decision.load(Ordering::Relaxed)
+    }
+
+    /// Average calls per second since the plugin was first invoked.
+    pub fn calls_per_second(&self) -> f64 {
+        let elapsed = self.started.elapsed().as_secs_f64();
+        if elapsed > 0.0 {
+            self.calls() as f64 / elapsed
+        } else {
+            0.0
+        }
+    }
+
+    /// Latency at the given percentile (0.0..=1.0), reported as the
+    /// upper bound of the histogram bucket the sample landed in.
+    pub fn percentile(&self, percentile: f64) -> Duration {
+        let total: u64 = self
+            .buckets
+            .iter()
+            .map(|bucket| bucket.load(Ordering::Relaxed))
+            .sum();
+        if total == 0 {
+            return Duration::ZERO;
+        }
+
+        let rank = ((total as f64) * percentile).ceil() as u64;
+        let mut seen = 0;
+
+        for (i, bucket) in self.buckets.iter().enumerate() {
+            seen += bucket.load(Ordering::Relaxed);
+            if seen >= rank {
+                return Duration::from_nanos(2u64.saturating_pow(i as u32 + 1));
+            }
+        }
+
+        Duration::from_nanos(u64::MAX)
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+
+    #[test]
+    fn test_percentiles() {
+        let stats = PluginStats::new();
+        for _ in 0..99 {
+            stats.record(Duration::from_nanos(1500), false); // bucket [1024, 2048)
+        }
+        stats.record(Duration::from_micros(300), true); // bucket [262144, 524288)
+
+        assert_eq!(stats.calls(), 100);
+        assert_eq!(stats.no_decision(), 1);
+        assert_eq!(stats.percentile(0.5), Duration::from_nanos(2048));
+        assert_eq!(stats.percentile(0.99), Duration::from_nanos(2048));
+        assert_eq!(stats.percentile(0.999), Duration::from_nanos(524288));
+    }
+}
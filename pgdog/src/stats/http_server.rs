@@ -10,7 +10,7 @@ use hyper_util::rt::TokioIo;
 use tokio::net::TcpListener;
 use tracing::info;
 
-use super::{Clients, Pools, QueryCache};
+use super::{Clients, PluginMetrics, Pools, QueryCache};
 
 async fn metrics(_: Request<hyper::body::Incoming>) -> Result<Response<Full<Bytes>>, Infallible> {
     let clients = Clients::load();
@@ -21,8 +21,14 @@ async fn metrics(_: Request<hyper::body::Incoming>) -> Result<Response<Full<Byte
         .map(|m| m.to_string())
         .collect();
     let query_cache = query_cache.join("\n");
+    let plugins: Vec<_> = PluginMetrics::load()
+        .metrics()
+        .into_iter()
+        .map(|m| m.to_string())
+        .collect();
+    let plugins = plugins.join("\n");
     Ok(Response::new(Full::new(Bytes::from(
-        clients.to_string() + "\n" + &pools.to_string() + "\n" + &query_cache,
+        clients.to_string() + "\n" + &pools.to_string() + "\n" + &query_cache + "\n" + &plugins,
     ))))
 }
 
@@ -5,9 +5,11 @@ pub mod open_metric;
 pub mod pools;
 pub use open_metric::*;
 pub mod logger;
+pub mod plugins;
 pub mod query_cache;
 
 pub use clients::Clients;
 pub use logger::Logger as StatsLogger;
+pub use plugins::PluginMetrics;
 pub use pools::{PoolMetric, Pools};
 pub use query_cache::QueryCache;
@@ -0,0 +1,121 @@
+//! Per-plugin routing latency metrics.
+
+use std::sync::Arc;
+
+use crate::plugin::stats::{self, PluginStats};
+
+use super::*;
+
+struct PluginMetric {
+    name: String,
+    help: String,
+    gauge: bool,
+    measurements: Vec<Measurement>,
+}
+
+pub struct PluginMetrics {
+    stats: Vec<(String, Arc<PluginStats>)>,
+}
+
+impl PluginMetrics {
+    pub(crate) fn load() -> Self {
+        PluginMetrics {
+            stats: stats::all(),
+        }
+    }
+
+    fn measurements(&self, value: impl Fn(&PluginStats) -> MeasurementType) -> Vec<Measurement> {
+        self.stats
+            .iter()
+            .map(|(name, stats)| Measurement {
+                labels: vec![("plugin".into(), name.clone())],
+                measurement: value(stats),
+            })
+            .collect()
+    }
+
+    pub(crate) fn metrics(&self) -> Vec<Metric> {
+        let mut metrics = vec![
+            Metric::new(PluginMetric {
+                name: "plugin_route_calls".into(),
+                help: "Routing calls made to the plugin".into(),
+                gauge: false,
+                measurements: self.measurements(|stats| (stats.calls() as i64).into()),
+            }),
+            Metric::new(PluginMetric {
+                name: "plugin_route_no_decision".into(),
+                help: "Routing calls the plugin made no decision for".into(),
+                gauge: false,
+                measurements: self.measurements(|stats| (stats.no_decision() as i64).into()),
+            }),
+            Metric::new(PluginMetric {
+                name: "plugin_route_calls_per_second".into(),
+                help: "Average routing calls per second".into(),
+                gauge: true,
+                measurements: self.measurements(|stats| stats.calls_per_second().into()),
+            }),
+            Metric::new(PluginMetric {
+                name: "plugin_route_p50_us".into(),
+                help: "Median routing latency, microseconds".into(),
+                gauge: true,
+                measurements: self
+                    .measurements(|stats| (stats.percentile(0.5).as_micros() as i64).into()),
+            }),
+            Metric::new(PluginMetric {
+                name: "plugin_route_p99_us".into(),
+                help: "p99 routing latency, microseconds".into(),
+                gauge: true,
+                measurements: self
+                    .measurements(|stats| (stats.percentile(0.99).as_micros() as i64).into()),
+            }),
+            Metric::new(PluginMetric {
+                name: "plugin_route_p999_us".into(),
+                help: "p999 routing latency, microseconds".into(),
+                gauge: true,
+                measurements: self
+                    .measurements(|stats| (stats.percentile(0.999).as_micros() as i64).into()),
+            }),
+        ];
+
+        // Counters plugins registered with pgdog_stats_counter.
+        let counters = pgdog_plugin::counter::counters();
+        if !counters.is_empty() {
+            metrics.push(Metric::new(PluginMetric {
+                name: "plugin_counter".into(),
+                help: "Counters registered by plugins".into(),
+                gauge: false,
+                measurements: counters
+                    .into_iter()
+                    .map(|(name, value)| Measurement {
+                        labels: vec![("name".into(), name)],
+                        measurement: (value as i64).into(),
+                    })
+                    .collect(),
+            }));
+        }
+
+        metrics
+    }
+}
+
+impl OpenMetric for PluginMetric {
+    fn name(&self) -> String {
+        self.name.clone()
+    }
+
+    fn metric_type(&self) -> String {
+        if self.gauge {
+            "gauge".into()
+        } else {
+            "counter".into()
+        }
+    }
+
+    fn help(&self) -> Option<String> {
+        Some(self.help.clone())
+    }
+
+    fn measurements(&self) -> Vec<Measurement> {
+        self.measurements.clone()
+    }
+}
@@ -1,6 +1,8 @@
 fn main() {
     println!("cargo:rerun-if-changed=postgres_hash/hashfn.c");
+    println!("cargo:rerun-if-changed=postgres_hash/postgres_hash.h");
     cc::Build::new()
         .file("postgres_hash/hashfn.c")
+        .include("postgres_hash")
         .compile("postgres_hash");
 }
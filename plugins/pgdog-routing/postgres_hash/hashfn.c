@@ -1,5 +1,7 @@
 #include <stdint.h>
 
+#include "postgres_hash.h"
+
 /*
  * PostgreSQL Database Management System
  * (formerly known as Postgres, then as Postgres95)
@@ -128,9 +130,7 @@ pg_rotate_left32(uint32 word, int n)
 uint64
 hash_combine64(uint64 a, uint64 b)
 {
-	/* 0x49a0f4dd15e5a8e3 is 64bit random data */
-	a ^= b + UINT64CONST(0x49a0f4dd15e5a8e3) + (a << 54) + (a >> 7);
-	return a;
+	return pg_hash_combine64(a, b);
 }
 
 /*
@@ -374,43 +374,167 @@ hash_bytes_extended(const unsigned char *k, int keylen)
 	return ((uint64) b << 32) | c;
 }
 
+uint64 hashint8extended(int64 val)
+{
+	return pg_hashint8extended(val);
+}
+
+uint64 hashint4extended(int32_t val)
+{
+	return pg_hashint4extended(val);
+}
+
+uint64 hashint2extended(int16_t val)
+{
+	return pg_hashint2extended(val);
+}
+
 /*
- * Both the seed and the magic number added at the end are from
- * https://stackoverflow.com/a/67189122
-*/
+ * Hash a batch of variable-length keys in one call.
+ *
+ * Results are identical to calling hash_bytes_extended once per key.
+ * Variable-length keys make SIMD lanes diverge, so this loops the
+ * scalar code; the win is one FFI crossing per batch instead of one
+ * per key.
+ */
+void
+hash_bytes_extended_batch(const unsigned char **keys, const int *lens,
+						  uint64 *out, int n)
+{
+	int			i;
+
+	for (i = 0; i < n; i++)
+		out[i] = hash_bytes_extended(keys[i], lens[i]);
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HAVE_AVX2_TARGET 1
+#include <immintrin.h>
+
+#define rot8(x,k) _mm256_or_si256(_mm256_slli_epi32(x, k), _mm256_srli_epi32(x, 32 - (k)))
+
+/* 8-wide final(): same arithmetic as the scalar macro, one key per lane. */
+#define final8(a,b,c) \
+{ \
+  c = _mm256_xor_si256(c, b); c = _mm256_sub_epi32(c, rot8(b,14)); \
+  a = _mm256_xor_si256(a, c); a = _mm256_sub_epi32(a, rot8(c,11)); \
+  b = _mm256_xor_si256(b, a); b = _mm256_sub_epi32(b, rot8(a,25)); \
+  c = _mm256_xor_si256(c, b); c = _mm256_sub_epi32(c, rot8(b,16)); \
+  a = _mm256_xor_si256(a, c); a = _mm256_sub_epi32(a, rot8(c, 4)); \
+  b = _mm256_xor_si256(b, a); b = _mm256_sub_epi32(b, rot8(a,14)); \
+  c = _mm256_xor_si256(c, b); c = _mm256_sub_epi32(c, rot8(b,24)); \
+}
 
-static uint64
-hash_bytes_uint32_extended(uint32 k)
+__attribute__((target("avx2")))
+static void
+hashint8extended_batch_avx2(const int64 *vals, uint64 *out, int n)
 {
-	uint32		a,
-				b,
-				c;
-	uint64 seed = HASH_PARTITION_SEED;
+	uint32		a0,
+				b0,
+				c0;
+	uint64		seed = HASH_PARTITION_SEED;
+	int			i;
+	int			j;
 
-	a = b = c = 0x9e3779b9 + (uint32) sizeof(uint32) + 3923095;
+	/*
+	 * The internal state is identical for every key until the key itself
+	 * is added, so the seed mix runs once and is broadcast to all lanes.
+	 */
+	a0 = b0 = c0 = 0x9e3779b9 + (uint32) sizeof(uint32) + 3923095;
+	a0 += (uint32) (seed >> 32);
+	b0 += (uint32) seed;
+	mix(a0, b0, c0);
 
-	if (seed != 0)
+	for (i = 0; i + 8 <= n; i += 8)
 	{
-		a += (uint32) (seed >> 32);
-		b += (uint32) seed;
-		mix(a, b, c);
+		uint32		k[8];
+		uint32		bs[8];
+		uint32		cs[8];
+		__m256i		a,
+					b,
+					c;
+
+		for (j = 0; j < 8; j++)
+		{
+			/* Same approach as hashint8 */
+			int64		val = vals[i + j];
+			uint32		lohalf = (uint32) val;
+			uint32		hihalf = (uint32) (val >> 32);
+
+			lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+			k[j] = lohalf;
+		}
+
+		a = _mm256_add_epi32(_mm256_set1_epi32(a0),
+							 _mm256_loadu_si256((const __m256i *) k));
+		b = _mm256_set1_epi32(b0);
+		c = _mm256_set1_epi32(c0);
+
+		final8(a, b, c);
+
+		_mm256_storeu_si256((__m256i *) bs, b);
+		_mm256_storeu_si256((__m256i *) cs, c);
+
+		for (j = 0; j < 8; j++)
+			out[i + j] = ((uint64) bs[j] << 32) | cs[j];
 	}
 
-	a += k;
+	for (; i < n; i++)
+		out[i] = hashint8extended(vals[i]);
+}
+#endif							/* __x86_64__ */
 
-	final(a, b, c);
+/*
+ * Hash a batch of BIGINT keys in one call.
+ *
+ * Results are identical to calling hashint8extended once per key.
+ * On x86-64 with AVX2, the final mixing runs eight keys at a time,
+ * one key per SIMD lane.
+ */
+void
+hashint8extended_batch(const int64 *vals, uint64 *out, int n)
+{
+	int			i;
 
-	/* report the result */
-	return ((uint64) b << 32) | c;
+#ifdef HAVE_AVX2_TARGET
+	if (__builtin_cpu_supports("avx2"))
+	{
+		hashint8extended_batch_avx2(vals, out, n);
+		return;
+	}
+#endif
+
+	for (i = 0; i < n; i++)
+		out[i] = hashint8extended(vals[i]);
 }
 
-uint64 hashint8extended(int64 val)
+/*
+ * Map a hash to a shard with jump consistent hash.
+ *
+ * Lamping & Veach, "A Fast, Minimal Memory, Consistent Hash
+ * Algorithm" (2014). Unlike hash % num_shards, growing from N to
+ * N + K shards moves only K / (N + K) of the keys -- the ones that
+ * land on the new shards -- and every other key stays put, so a
+ * reshard is an incremental migration instead of a near-full one.
+ *
+ * The key should already be well mixed, e.g. the output of
+ * hashint8extended or hash_bytes_extended. num_shards must be
+ * positive.
+ */
+int
+shard_for_key(uint64 key, int num_shards)
 {
-	/* Same approach as hashint8 */
-	uint32		lohalf = (uint32) val;
-	uint32		hihalf = (uint32) (val >> 32);
+	int64		b = -1;
+	int64		j = 0;
 
-	lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+	while (j < num_shards)
+	{
+		b = j;
+		key = key * 2862933555777941757ULL + 1;
+		j = (int64) ((double) (b + 1) *
+					 ((double) (1ULL << 31) /
+					  (double) ((key >> 33) + 1)));
+	}
 
-	return hash_bytes_uint32_extended(lohalf);
+	return (int) b;
 }
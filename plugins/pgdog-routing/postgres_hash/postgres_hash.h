@@ -0,0 +1,131 @@
+/*
+ * Inline fast paths for fixed-width key hashing.
+ *
+ * Derived from hashfn.c (PostgreSQL Database Management System,
+ * see the license at the top of that file). The variable-length
+ * hash_bytes_extended stays in hashfn.c; the fixed-width paths are
+ * a handful of arithmetic ops each, so calling them through the
+ * static library costs as much as the work itself. Including this
+ * header lets the compiler inline them at the call site instead.
+ *
+ * Results are bit-identical to the exported hashfn.c functions and
+ * to PostgreSQL's own hash partitioning: pg_hashint8extended
+ * matches hashint8extended(val, HASH_PARTITION_SEED), and the int2
+ * and int4 specializations match hashint2extended and
+ * hashint4extended, which hash the sign-extended 32-bit value.
+ */
+#ifndef POSTGRES_HASH_H
+#define POSTGRES_HASH_H
+
+#include <stdint.h>
+
+#define PG_HASH_PARTITION_SEED UINT64_C(0x7A5B22367996DCFD)
+
+static inline uint32_t
+pg_hash_rot(uint32_t word, int n)
+{
+	return (word << n) | (word >> (32 - n));
+}
+
+/* mix -- mix 3 32-bit values reversibly. See hashfn.c. */
+#define pg_hash_mix(a,b,c) \
+{ \
+  a -= c;  a ^= pg_hash_rot(c, 4);	c += b; \
+  b -= a;  b ^= pg_hash_rot(a, 6);	a += c; \
+  c -= b;  c ^= pg_hash_rot(b, 8);	b += a; \
+  a -= c;  a ^= pg_hash_rot(c,16);	c += b; \
+  b -= a;  b ^= pg_hash_rot(a,19);	a += c; \
+  c -= b;  c ^= pg_hash_rot(b, 4);	b += a; \
+}
+
+/* final -- final mixing of 3 32-bit values (a,b,c) into c. See hashfn.c. */
+#define pg_hash_final(a,b,c) \
+{ \
+  c ^= b; c -= pg_hash_rot(b,14); \
+  a ^= c; a -= pg_hash_rot(c,11); \
+  b ^= a; b -= pg_hash_rot(a,25); \
+  c ^= b; c -= pg_hash_rot(b,16); \
+  a ^= c; a -= pg_hash_rot(c, 4); \
+  b ^= a; b -= pg_hash_rot(a,14); \
+  c ^= b; c -= pg_hash_rot(b,24); \
+}
+
+/*
+ * Combine two 64-bit hash values, resulting in another hash value,
+ * using the same kind of technique as hash_combine(). Testing shows
+ * that this also produces good bit mixing.
+ */
+static inline uint64_t
+pg_hash_combine64(uint64_t a, uint64_t b)
+{
+	/* 0x49a0f4dd15e5a8e3 is 64bit random data */
+	a ^= b + UINT64_C(0x49a0f4dd15e5a8e3) + (a << 54) + (a >> 7);
+	return a;
+}
+
+/*
+ * Hash a 32-bit value with the partition seed.
+ *
+ * Both the seed and the magic number added at the end are from
+ * https://stackoverflow.com/a/67189122
+ */
+static inline uint64_t
+pg_hash_uint32_extended(uint32_t k)
+{
+	uint32_t	a,
+				b,
+				c;
+	uint64_t	seed = PG_HASH_PARTITION_SEED;
+
+	a = b = c = 0x9e3779b9 + (uint32_t) sizeof(uint32_t) + 3923095;
+
+	/* The partition seed is never zero. */
+	a += (uint32_t) (seed >> 32);
+	b += (uint32_t) seed;
+	pg_hash_mix(a, b, c);
+
+	a += k;
+
+	pg_hash_final(a, b, c);
+
+	/* report the result */
+	return ((uint64_t) b << 32) | c;
+}
+
+/*
+ * Hash a BIGINT the way Postgres hashes a BIGINT partition key:
+ * fold the high half into the low half so that values fitting in
+ * 32 bits hash the same as their int4 representation.
+ */
+static inline uint64_t
+pg_hashint8extended(int64_t val)
+{
+	/* Same approach as hashint8 */
+	uint32_t	lohalf = (uint32_t) val;
+	uint32_t	hihalf = (uint32_t) (val >> 32);
+
+	lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+
+	return pg_hash_uint32_extended(lohalf);
+}
+
+/*
+ * Hash an INTEGER partition key.
+ */
+static inline uint64_t
+pg_hashint4extended(int32_t val)
+{
+	return pg_hash_uint32_extended((uint32_t) val);
+}
+
+/*
+ * Hash a SMALLINT partition key. Sign-extended to 32 bits first,
+ * matching hashint2extended.
+ */
+static inline uint64_t
+pg_hashint2extended(int16_t val)
+{
+	return pg_hash_uint32_extended((uint32_t) (int32_t) val);
+}
+
+#endif							/* POSTGRES_HASH_H */
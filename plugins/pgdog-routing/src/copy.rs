@@ -4,7 +4,9 @@ use csv::ReaderBuilder;
 use pg_query::{protobuf::CopyStmt, NodeEnum};
 use pgdog_plugin::bindings::*;
 
-use crate::sharding_function::bigint;
+use pgdog_plugin::scan::scan_binary_rows;
+
+use crate::sharding_function::bigint_batch;
 
 /// Parse COPY statement.
 pub fn parse(stmt: &CopyStmt) -> Result<Copy, pg_query::Error> {
@@ -25,14 +27,18 @@ pub fn parse(stmt: &CopyStmt) -> Result<Copy, pg_query::Error> {
             }
         }
 
+        let mut binary = false;
+
         for option in &stmt.options {
             if let Some(NodeEnum::DefElem(ref elem)) = option.node {
                 match elem.defname.to_lowercase().as_str() {
                     "format" => {
                         if let Some(ref arg) = elem.arg {
                             if let Some(NodeEnum::String(ref string)) = arg.node {
-                                if string.sval.to_lowercase().as_str() == "csv" {
-                                    csv = true;
+                                match string.sval.to_lowercase().as_str() {
+                                    "csv" => csv = true,
+                                    "binary" => binary = true,
+                                    _ => (),
                                 }
                             }
                         }
@@ -55,6 +61,10 @@ pub fn parse(stmt: &CopyStmt) -> Result<Copy, pg_query::Error> {
             }
         }
 
+        if binary {
+            return Ok(Copy::binary(&rel.relname, &columns));
+        }
+
         if csv {
             return Ok(Copy::new(&rel.relname, headers, delimiter, &columns));
         }
@@ -67,48 +77,128 @@ pub fn parse(stmt: &CopyStmt) -> Result<Copy, pg_query::Error> {
 /// and determine where each row should go.
 pub fn copy_data(input: CopyInput, shards: usize) -> Result<CopyOutput, csv::Error> {
     let data = input.data();
-    let mut csv = ReaderBuilder::new()
-        .has_headers(input.headers())
-        .delimiter(input.delimiter() as u8)
-        .from_reader(data);
+    let spans = input.row_spans();
 
-    let mut rows = vec![];
+    let mut records = vec![];
+    let mut header = None;
+
+    if input.is_binary() {
+        // Length-prefixed tuples: the sharding key is a fixed-width
+        // big-endian field read straight out of the tuple, no text
+        // decode. pgDog re-frames the stream header and trailer per
+        // shard, so each row is exactly one tuple.
+        let scanned;
+        let spans = if spans.is_empty() {
+            scanned = scan_binary_rows(data, input.sharding_column());
+            &scanned[..]
+        } else {
+            spans
+        };
+
+        for span in spans {
+            let key = match span.key(data) {
+                key if key.len() == 8 => Some(i64::from_be_bytes(key.try_into().unwrap())),
+                key if key.len() == 4 => Some(i32::from_be_bytes(key.try_into().unwrap()) as i64),
+                key if key.len() == 2 => Some(i16::from_be_bytes(key.try_into().unwrap()) as i64),
+                _ => None,
+            };
+            records.push((span.row(data), key));
+        }
+    } else if !spans.is_empty() {
+        // Fast path: pgDog already found row boundaries and sharding
+        // key spans with its vectorized pre-scan. Hash the key bytes
+        // directly instead of re-parsing the CSV byte by byte.
+        for (i, span) in spans.iter().enumerate() {
+            let start = span.row_start as usize;
+            // Include the row terminator (\n or \r\n).
+            let mut end = start + span.row_len as usize;
+            while end < data.len() && data[end] != b'\n' {
+                end += 1;
+            }
+            let end = (end + 1).min(data.len());
 
-    while let Some(record) = csv.records().next() {
-        let record = record?;
-        if let Some(position) = record.position() {
-            let start = position.byte() as usize;
-            let end = start + record.as_slice().len();
-            // N.B.: includes \n character which indicates the end of a single CSV record.
-            // If CSV is encoded using Windows \r\n, this will break.
-            if let Some(row_data) = data.get(start..=end + 1) {
-                let key = record.iter().nth(input.sharding_column());
-                let shard = key
-                    .and_then(|k| k.parse::<i64>().ok().map(|k| bigint(k, shards) as i64))
-                    .unwrap_or(-1);
-
-                let row = CopyRow::new(row_data, shard as i32);
-                rows.push(row);
+            if i == 0 && input.headers() {
+                header = std::str::from_utf8(span.row(data))
+                    .ok()
+                    .map(|header| header.to_string() + "\n");
+                continue;
             }
+
+            let key = std::str::from_utf8(span.key(data))
+                .ok()
+                .and_then(|key| key.parse::<i64>().ok());
+            records.push((&data[start..end], key));
+        }
+    } else {
+        let mut csv = ReaderBuilder::new()
+            .has_headers(input.headers())
+            .delimiter(input.delimiter() as u8)
+            .from_reader(data);
+
+        while let Some(record) = csv.records().next() {
+            let record = record?;
+            if let Some(position) = record.position() {
+                let start = position.byte() as usize;
+                let end = start + record.as_slice().len();
+                // N.B.: includes \n character which indicates the end of a single CSV record.
+                // If CSV is encoded using Windows \r\n, this will break.
+                if let Some(row_data) = data.get(start..=end + 1) {
+                    let key = record
+                        .iter()
+                        .nth(input.sharding_column())
+                        .and_then(|k| k.parse::<i64>().ok());
+                    records.push((row_data, key));
+                }
+            }
+        }
+
+        if csv.has_headers() {
+            header = csv.headers().ok().map(|s| {
+                s.into_iter()
+                    .collect::<Vec<_>>()
+                    .join(input.delimiter().to_string().as_str())
+                    + "\n" // New line indicating the end of a CSV line.
+            });
         }
     }
 
-    Ok(CopyOutput::new(&rows).with_header(if csv.has_headers() {
-        csv.headers().ok().map(|s| {
-            s.into_iter()
-                .collect::<Vec<_>>()
-                .join(input.delimiter().to_string().as_str())
-                + "\n" // New line indicating the end of a CSV line.
-        })
-    } else {
-        None
-    }))
+    // Hash all sharding keys in one FFI crossing instead of one per row.
+    let keys = records
+        .iter()
+        .filter_map(|(_, key)| *key)
+        .collect::<Vec<_>>();
+    let mut key_shards = bigint_batch(&keys, shards).into_iter();
+
+    // Streaming mode: fill the caller's reusable ring slots in place,
+    // zero-copy into the input buffer, so pgDog can drain them to
+    // backends while we keep sharding. Rows that don't fit because
+    // the ring is full go into the batch output as a fallback.
+    let ring = input.ring();
+
+    let mut rows = vec![];
+    for (row_data, key) in records {
+        let shard = match key {
+            Some(_) => key_shards.next().unwrap_or(0) as i32,
+            None => -1,
+        };
+
+        // Every row references the input buffer: pgDog writes it to
+        // its shard with vectored I/O, no copy of the row bytes.
+        let row = CopyRow::borrowed(row_data, shard);
+        match ring {
+            Some(ring) if ring.push(row) => (),
+            _ => rows.push(row),
+        }
+    }
+
+    Ok(CopyOutput::new(&rows).with_header(header))
 }
 
 #[cfg(test)]
 mod test {
 
     use super::*;
+    use crate::sharding_function::bigint;
 
     #[test]
     fn test_copy() {
@@ -134,10 +224,85 @@ mod test {
         assert_eq!(rows.next().unwrap().shard, bigint(1, 4) as i32);
         assert_eq!(rows.next().unwrap().shard, bigint(2, 4) as i32);
         assert_eq!(output.header(), Some("id;email\n"));
+        assert!(output.rows().iter().all(|row| row.is_borrowed()));
 
         unsafe {
             copy.deallocate();
             output.deallocate();
         }
     }
+
+    #[test]
+    fn test_copy_prescanned() {
+        let data = "id;email\n1;test@test.com\n2;admin@test.com\n";
+        let spans = pgdog_plugin::scan::scan_rows(data.as_bytes(), b';', 0);
+
+        let input = CopyInput::new(data.as_bytes(), 0, true, ';').with_row_spans(&spans);
+        let output = copy_data(input, 4).unwrap();
+
+        let mut rows = output.rows().iter();
+        assert_eq!(rows.next().unwrap().shard, bigint(1, 4) as i32);
+        assert_eq!(rows.next().unwrap().shard, bigint(2, 4) as i32);
+        assert_eq!(output.header(), Some("id;email\n"));
+
+        unsafe { output.deallocate() };
+    }
+
+    #[test]
+    fn test_copy_binary() {
+        use pgdog_plugin::scan::BINARY_SIGNATURE;
+
+        let stmt = "COPY test_table (id) FROM 'some_file.bin' WITH (FORMAT binary)";
+        let ast = pg_query::parse(stmt).unwrap();
+        let copy = ast.protobuf.stmts.first().unwrap().stmt.clone().unwrap();
+
+        let copy = match copy.node {
+            Some(NodeEnum::CopyStmt(ref stmt)) => parse(stmt).unwrap(),
+            _ => panic!("not COPY"),
+        };
+        assert_eq!(copy.copy_format, CopyFormat_BINARY);
+
+        let mut data = vec![];
+        data.extend_from_slice(BINARY_SIGNATURE);
+        data.extend_from_slice(&0i32.to_be_bytes()); // flags
+        data.extend_from_slice(&0i32.to_be_bytes()); // extension length
+        for id in [1i64, 2] {
+            data.extend_from_slice(&1i16.to_be_bytes());
+            data.extend_from_slice(&8i32.to_be_bytes());
+            data.extend_from_slice(&id.to_be_bytes());
+        }
+        data.extend_from_slice(&(-1i16).to_be_bytes());
+
+        let input = CopyInput::new(&data, 0, false, ',').with_format(CopyFormat_BINARY);
+        let output = copy_data(input, 4).unwrap();
+
+        let mut rows = output.rows().iter();
+        assert_eq!(rows.next().unwrap().shard, bigint(1, 4) as i32);
+        assert_eq!(rows.next().unwrap().shard, bigint(2, 4) as i32);
+
+        unsafe {
+            copy.deallocate();
+            output.deallocate();
+        }
+    }
+
+    #[test]
+    fn test_copy_streaming() {
+        let data = "1;test@test.com\n2;admin@test.com\n";
+        let mut ring = CopyRing::new(4);
+
+        let input = CopyInput::new(data.as_bytes(), 0, false, ';').with_ring(&mut ring);
+        let output = copy_data(input, 4).unwrap();
+
+        // Rows went into the ring, not the batch output.
+        assert!(output.rows().is_empty());
+        assert_eq!(ring.len(), 2);
+        assert_eq!(ring.pop().unwrap().shard, bigint(1, 4) as i32);
+        assert_eq!(ring.pop().unwrap().shard, bigint(2, 4) as i32);
+
+        unsafe {
+            output.deallocate();
+            ring.deallocate();
+        }
+    }
 }
@@ -3,23 +3,43 @@
 
 use once_cell::sync::Lazy;
 use pg_query::{parse, NodeEnum};
-use pgdog_plugin::bindings::{Config, Input, Output};
+use pgdog_plugin::bindings::{
+    self, Config, Input, Output, StatementKind_STATEMENT_DELETE, StatementKind_STATEMENT_INSERT,
+    StatementKind_STATEMENT_SELECT, StatementKind_STATEMENT_UPDATE,
+};
 use pgdog_plugin::Route;
+use uuid::Uuid;
 
 use tracing::{debug, level_filters::LevelFilter};
 use tracing::{error, trace};
 use tracing_subscriber::{fmt, prelude::*, EnvFilter};
 
 use std::io::IsTerminal;
-use std::sync::atomic::{AtomicUsize, Ordering};
+use std::ptr::null_mut;
+use std::sync::atomic::{AtomicPtr, AtomicUsize, Ordering};
 
 static SHARD_ROUND_ROBIN: Lazy<AtomicUsize> = Lazy::new(|| AtomicUsize::new(0));
 
+/// Latest config snapshot received from pgDog.
+static CONFIG: AtomicPtr<Config> = AtomicPtr::new(null_mut());
+
 pub mod comment;
 pub mod copy;
 pub mod order_by;
 pub mod sharding_function;
 
+/// ABI version this plugin was compiled against.
+#[no_mangle]
+pub extern "C" fn pgdog_api_version() -> std::ffi::c_int {
+    bindings::PGDOG_API_VERSION as std::ffi::c_int
+}
+
+/// Calling conventions this plugin supports.
+#[no_mangle]
+pub extern "C" fn pgdog_capabilities() -> u64 {
+    (bindings::PGDOG_CAP_ROUTE_BATCH | bindings::PGDOG_CAP_COPY_BORROWED) as u64
+}
+
 #[no_mangle]
 pub extern "C" fn pgdog_init() {
     let format = fmt::layer()
@@ -41,15 +61,72 @@ pub extern "C" fn pgdog_init() {
     debug!("🐕 pgDog routing plugin v{}", env!("CARGO_PKG_VERSION"));
 }
 
+/// Per-thread initialization. We keep no thread-local state yet,
+/// but implementing the hook documents the callback for plugin
+/// authors who do.
+#[no_mangle]
+pub extern "C" fn pgdog_init_thread(thread_id: std::ffi::c_int, num_threads: std::ffi::c_int) {
+    debug!("🐕 worker thread {}/{} online", thread_id, num_threads);
+}
+
+/// Cache the config snapshot pgDog hands us on load and on every
+/// topology change. The snapshot is immutable and owned by pgDog,
+/// so a shallow copy of the descriptor is enough.
+///
+/// # Safety
+///
+/// `config` must point to a valid Config that outlives the plugin.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_config_update(config: *const Config, generation: u64) {
+    if config.is_null() {
+        return;
+    }
+
+    // Old generations are leaked on purpose: updates are rare and
+    // in-flight queries may still be reading the previous snapshot.
+    let snapshot = Box::into_raw(Box::new(*config));
+    CONFIG.store(snapshot, Ordering::Release);
+
+    debug!(
+        "🐕 config generation {} ({} shards)",
+        generation,
+        (*snapshot).shards
+    );
+}
+
+/// Get the current config snapshot, if pgDog sent us one.
+fn config() -> Option<Config> {
+    let snapshot = CONFIG.load(Ordering::Acquire);
+    if snapshot.is_null() {
+        None
+    } else {
+        Some(unsafe { *snapshot })
+    }
+}
+
 #[no_mangle]
 pub extern "C" fn pgdog_route_query(input: Input) -> Output {
+    let config = match config() {
+        Some(config) => config,
+        // No topology to route against yet.
+        None => return Output::skip(),
+    };
+
     if let Some(query) = input.query() {
-        match route_internal(query.query(), input.config) {
+        // pgDog's router already parsed the statement; use its
+        // metadata instead of parsing the query again.
+        if let Some(output) = route_fast_path(&query, config.shards as usize) {
+            return output;
+        }
+
+        match route_internal(query.query(), config) {
             Ok(output) => output,
             Err(_) => Output::new_forward(Route::unknown()),
         }
+    } else if let Some(pipeline) = input.pipeline() {
+        route_pipeline(&pipeline, config)
     } else if let Some(copy_input) = input.copy() {
-        match copy::copy_data(copy_input, input.config.shards as usize) {
+        match copy::copy_data(copy_input, config.shards as usize) {
             Ok(output) => Output::new_copy_rows(output),
             Err(err) => {
                 error!("{:?}", err);
@@ -61,6 +138,137 @@ pub extern "C" fn pgdog_route_query(input: Input) -> Output {
     }
 }
 
+/// Route a whole pipeline of queries in one FFI crossing.
+///
+/// Pipelined clients queue many queries per connection; routing them
+/// in a batch amortizes the per-call marshalling overhead.
+///
+/// # Safety
+///
+/// `inputs` and `outputs` must point to `n` valid entries each.
+#[no_mangle]
+pub unsafe extern "C" fn pgdog_route_query_batch(
+    inputs: *const Input,
+    outputs: *mut Output,
+    n: std::ffi::c_int,
+) {
+    for i in 0..n as usize {
+        *outputs.add(i) = pgdog_route_query(*inputs.add(i));
+    }
+}
+
+/// Route every statement of a pipeline in one call.
+///
+/// Statements are routed individually first. If every statement that
+/// could be pinned landed on the same concrete shard, the statements
+/// that could go anywhere (ANY) are pinned to it too, keeping the
+/// pipeline on one shard so the client observes its queries executing
+/// in order. ALL routes are never rewritten: a keyless write or
+/// cross-shard read has to reach every shard no matter what the rest
+/// of the pipeline does. Statements that disagree on a shard are left
+/// on their own routes. Per-statement read/write affinity is
+/// preserved either way.
+///
+/// Decisions other than FORWARD are freed and degrade to an unknown
+/// route: COPY isn't supported inside a pipeline.
+fn route_pipeline(pipeline: &bindings::Pipeline, config: Config) -> Output {
+    let shards = config.shards as usize;
+    let mut routes = Vec::with_capacity(pipeline.queries().len());
+
+    for query in pipeline.queries() {
+        let output = if let Some(output) = route_fast_path(query, shards) {
+            output
+        } else {
+            match route_internal(query.query(), config) {
+                Ok(output) => output,
+                Err(_) => Output::new_forward(Route::unknown()),
+            }
+        };
+
+        // A non-FORWARD decision (COPY isn't supported inside a
+        // pipeline) degrades to an unknown route; free whatever the
+        // decision allocated before dropping it.
+        routes.push(match output.route() {
+            Some(route) => route,
+            None => {
+                unsafe { output.deallocate() };
+                Route::unknown()
+            }
+        });
+    }
+
+    // The shard the pinned statements agree on, if they agree.
+    let mut pinned: Option<i32> = None;
+    let mut coherent = true;
+    for route in &routes {
+        if route.shard < 0 {
+            continue;
+        }
+        match pinned {
+            Some(shard) if shard != route.shard => {
+                coherent = false;
+                break;
+            }
+            Some(_) => (),
+            None => pinned = Some(route.shard),
+        }
+    }
+
+    if coherent {
+        if let Some(shard) = pinned {
+            for route in routes.iter_mut() {
+                if route.is_any_shard() {
+                    route.shard = shard;
+                }
+            }
+        }
+    }
+
+    Output::new_forward_pipeline(&routes)
+}
+
+/// Route using statement metadata precomputed by pgDog's parser,
+/// skipping our own parse of the query text.
+///
+/// Only applies when pgDog located an equality predicate on the
+/// sharding column: the query then goes to exactly one shard and
+/// no cross-shard ORDER BY extraction is needed.
+fn route_fast_path(query: &bindings::Query, shards: usize) -> Option<Output> {
+    let predicate = query.sharding_key_predicate(0)?;
+
+    let shard = if let Some(index) = predicate.parameter_index() {
+        // Bound parameter: typed accessors handle both text and
+        // binary format without conversion.
+        let param = query.parameter(index)?;
+        if let Some(id) = param.as_int8() {
+            sharding_function::bigint(id, shards)
+        } else if let Some(id) = param.as_uuid() {
+            sharding_function::uuid(Uuid::from_bytes(id), shards)
+        } else {
+            return None;
+        }
+    } else {
+        let value = predicate.value()?;
+        let value = value.trim_matches('\'');
+
+        if let Ok(id) = value.parse::<i64>() {
+            sharding_function::bigint(id, shards)
+        } else if let Ok(id) = value.parse::<Uuid>() {
+            sharding_function::uuid(id, shards)
+        } else {
+            return None;
+        }
+    };
+
+    match query.statement_kind {
+        StatementKind_STATEMENT_SELECT => Some(Output::new_forward(Route::read(shard))),
+        StatementKind_STATEMENT_INSERT
+        | StatementKind_STATEMENT_UPDATE
+        | StatementKind_STATEMENT_DELETE => Some(Output::new_forward(Route::write(shard))),
+        _ => None,
+    }
+}
+
 fn route_internal(query: &str, config: Config) -> Result<Output, pg_query::Error> {
     let shards = config.shards;
     let databases = config.databases();